@@ -0,0 +1,121 @@
+//  :       
+#include "arithmetic.h"
+#include "expression_generator.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <new>
+namespace {
+size_t currentBytes = 0;
+size_t peakBytes = 0;
+const size_t ALLOCATION_HEADER = 16;
+struct TCase {
+	const char* name;
+	TGeneratorParams params;
+};
+struct TPhaseResult {
+	double seconds;
+	size_t peak;
+};
+TPhaseResult measure(const std::function<void()>& phase) {
+	size_t before = currentBytes;
+	peakBytes = currentBytes;
+	auto start = std::chrono::steady_clock::now();
+	phase();
+	auto stop = std::chrono::steady_clock::now();
+	TPhaseResult result;
+	result.seconds = std::chrono::duration<double>(stop - start).count();
+	result.peak = peakBytes - before;
+	return result;
+}
+void report(const char* phase, const TPhaseResult& result, size_t tokens, size_t bytes) {
+	std::printf("  %-14s %10.3f ms %12.2f Mtok/s %10.2f MB/s %12.2f MB peak\n", phase, result.seconds * 1e3,
+		tokens / result.seconds / 1e6, bytes / result.seconds / 1e6, result.peak / 1e6);
+}
+TCase makeCase(const char* name, uint64_t seed, size_t operands, size_t maxDepth, size_t variables, double open, double close) {
+	TCase c;
+	c.name = name;
+	c.params.seed = seed;
+	c.params.operands = operands;
+	c.params.maxDepth = maxDepth;
+	c.params.variables = variables;
+	c.params.openProbability = open;
+	c.params.closeProbability = close;
+	return c;
+}
+void runCase(const TCase& c, size_t rows) {
+	TExpressionGenerator generator(c.params.seed);
+	std::string infix = generator.generate(c.params);
+	TPostfix postfix(infix);
+	std::vector<std::string> names = TExpressionGenerator::variableNames(c.params.variables);
+	for (size_t i = 0; i < names.size(); i++) {
+		postfix.SetVariable(names[i], 1.0 + 0.001 * i);
+	}
+	size_t tokens = postfix.tokenize().size();
+	std::printf("%s: %zu bytes, %zu tokens, seed %llu\n", c.name, infix.size(), tokens,
+		static_cast<unsigned long long>(c.params.seed));
+	report("tokenize", measure([&] { postfix.tokenize(); }), tokens, infix.size());
+	report("validate", measure([&] { postfix.validate(); }), tokens, infix.size());
+	report("toPostfix", measure([&] { postfix.toPostfix(); }), tokens, infix.size());
+	report("compile", measure([&] { postfix.compile(); }), tokens, infix.size());
+	report("calculate", measure([&] { postfix.calculate(); }), tokens, infix.size());
+	std::vector<std::vector<double>> data(names.size(), std::vector<double>(rows));
+	std::map<std::string, const double*> columns;
+	for (size_t i = 0; i < names.size(); i++) {
+		for (size_t j = 0; j < rows; j++) {
+			data[i][j] = 1.0 + 0.001 * ((i + j) % 100);
+		}
+		columns[names[i]] = data[i].data();
+	}
+	std::vector<double> result(rows);
+	report("calculateBatch", measure([&] { postfix.calculateBatch(columns, rows, result.data()); }), tokens * rows, infix.size() * rows);
+}
+}
+void* operator new(size_t size) {
+	void* block = std::malloc(size + ALLOCATION_HEADER);
+	if (block == nullptr) {
+		throw std::bad_alloc();
+	}
+	std::memcpy(block, &size, sizeof(size));
+	currentBytes += size;
+	if (currentBytes > peakBytes) {
+		peakBytes = currentBytes;
+	}
+	return static_cast<char*>(block) + ALLOCATION_HEADER;
+}
+void operator delete(void* p) noexcept {
+	if (p == nullptr) {
+		return;
+	}
+	void* block = static_cast<char*>(p) - ALLOCATION_HEADER;
+	size_t size;
+	std::memcpy(&size, block, sizeof(size));
+	currentBytes -= size;
+	std::free(block);
+}
+void operator delete(void* p, size_t) noexcept {
+	operator delete(p);
+}
+int main(int argc, char** argv) {
+	bool quick = argc > 1 && std::strcmp(argv[1], "--quick") == 0;
+	size_t scale = quick ? 10 : 1;
+	std::vector<TCase> cases = {
+		makeCase("flat", 1, 500000 / scale, 0, 16, 0.0, 0.0),
+		makeCase("random", 2, 200000 / scale, 64, 16, 0.2, 0.2),
+		makeCase("deep", 3, 20000 / scale, 10000 / scale, 8, 0.9, 0.05),
+		makeCase("wide", 4, 200000 / scale, 8, 500, 0.1, 0.3),
+	};
+	for (const TCase& c : cases) {
+		try {
+			runCase(c, quick ? 256 : 4096);
+		}
+		catch (const std::exception& e) {
+			std::cout << c.name << ": ERROR: " << e.what() << std::endl;
+			return 1;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,73 @@
+//     
+#include "expression_generator.h"
+#include <cstdio>
+TGeneratorParams::TGeneratorParams() : seed(1), operands(1000), maxDepth(16), variables(8),
+	openProbability(0.2), closeProbability(0.2), numberProbability(0.5), operators("+-*") {}
+TExpressionGenerator::TExpressionGenerator(uint64_t seed) : state(seed) {}
+uint64_t TExpressionGenerator::next() {
+	uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+double TExpressionGenerator::uniform() {
+	return static_cast<double>(next() >> 11) / 9007199254740992.0;
+}
+size_t TExpressionGenerator::below(size_t bound) {
+	return static_cast<size_t>(next() % bound);
+}
+std::vector<std::string> TExpressionGenerator::variableNames(size_t count) {
+	std::vector<std::string> names;
+	for (size_t i = 0; i < count; i++) {
+		std::string name;
+		size_t n = i;
+		do {
+			name += static_cast<char>('a' + n % 26);
+			n /= 26;
+		} while (n > 0);
+		names.push_back(name);
+	}
+	return names;
+}
+std::string TExpressionGenerator::generate(const TGeneratorParams& params) {
+	state = params.seed;
+	std::vector<std::string> names = variableNames(params.variables);
+	std::string result;
+	result.reserve(params.operands * 8 + params.maxDepth * 2);
+	size_t emitted = 0;
+	size_t depth = 0;
+	bool expectOperand = true;
+	char buffer[32];
+	while (true) {
+		if (expectOperand) {
+			if (emitted + 1 < params.operands && depth < params.maxDepth && uniform() < params.openProbability) {
+				result += '(';
+				depth++;
+				continue;
+			}
+			if (names.empty() || uniform() < params.numberProbability) {
+				std::snprintf(buffer, sizeof(buffer), "%u.%02u", static_cast<unsigned>(1 + below(99)), static_cast<unsigned>(below(100)));
+				result += buffer;
+			}
+			else {
+				result += names[below(names.size())];
+			}
+			emitted++;
+			expectOperand = false;
+			continue;
+		}
+		if (depth > 0 && (emitted >= params.operands || uniform() < params.closeProbability)) {
+			result += ')';
+			depth--;
+			continue;
+		}
+		if (emitted >= params.operands) {
+			break;
+		}
+		result += ' ';
+		result += params.operators[below(params.operators.size())];
+		result += ' ';
+		expectOperand = true;
+	}
+	return result;
+}
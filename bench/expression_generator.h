@@ -0,0 +1,28 @@
+//       
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+struct TGeneratorParams {
+	uint64_t seed;
+	size_t operands;
+	size_t maxDepth;
+	size_t variables;
+	double openProbability;
+	double closeProbability;
+	double numberProbability;
+	std::string operators;
+	TGeneratorParams();
+};
+class TExpressionGenerator {
+private:
+	uint64_t state;
+	uint64_t next();
+	double uniform();
+	size_t below(size_t bound);
+public:
+	explicit TExpressionGenerator(uint64_t seed);
+	std::string generate(const TGeneratorParams& params);
+	static std::vector<std::string> variableNames(size_t count);
+};
@@ -1,34 +1,202 @@
 //        
+#pragma once
+#include "functions.h"
+#include "expected.h"
+#include "tokens.h"
+#include "pool.h"
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
+#include <memory>
+#include <memory_resource>
 struct Token {
 	std::string value;
 	std::string type;
-	Token(const std::string& val = "", const std::string& typ = "");
+	double number;
+	int arity;
+	size_t offset;
+	Token(const std::string& val = "", const std::string& typ = "", double num = 0.0, size_t off = 0);
 };
+enum class OpCode : unsigned char {
+	Number,
+	Variable,
+	Add,
+	Sub,
+	Mul,
+	Div,
+	Pow,
+	PowInt,
+	Sin,
+	Cos,
+	Exp,
+	Log,
+	Sqrt,
+	Abs,
+	Min,
+	Max,
+	Call,
+	Less,
+	LessEqual,
+	Greater,
+	GreaterEqual,
+	Equal,
+	NotEqual,
+	And,
+	Or,
+	Not,
+	Select,
+	JumpIfZero,
+	Jump,
+	AndJump,
+	OrJump,
+	Sum,
+	Product,
+	CompensatedSum
+};
+struct Instruction {
+	OpCode op;
+	int arg;
+};
+struct FunctionReference {
+	std::string name;
+	int arity;
+};
+// stackDepth -      , 0 -  
+struct CompiledExpression {
+	std::vector<Instruction> code;
+	std::vector<double> constants;
+	std::vector<std::string> names;
+	std::vector<FunctionReference> functions;
+	size_t stackDepth = 0;
+};
+// Strict -  ,  ; Pairwise -  +  *   n- ,
+//  ; Compensated -  ,       ()
+enum class Reassociation {
+	Strict,
+	Pairwise,
+	Compensated
+};
+enum BatchError : unsigned char {
+	BATCH_DIVISION_BY_ZERO = 1,
+	BATCH_NOT_A_NUMBER = 2,
+	BATCH_INFINITY = 4
+};
+enum class BatchStatus {
+	Ok,
+	InvalidExpression,
+	UndefinedVariable,
+	UnknownFunction
+};
+struct TBatchOptions {
+	bool divisionByZeroIsError = true;
+	bool nanIsError = false;
+	bool infinityIsError = false;
+};
+struct TBatchReport {
+	BatchStatus status = BatchStatus::Ok;
+	std::string message;
+	std::vector<unsigned char> rowErrors;
+	size_t divisionByZero = 0;
+	size_t notANumber = 0;
+	size_t infinity = 0;
+	size_t failedRows = 0;
+};
+enum class ParseErrorKind {
+	EmptyExpression,
+	InvalidName,
+	UnknownOperator,
+	UnmatchedBracket,
+	UnmatchedCondition,
+	ArgumentCount,
+	MisplacedSeparator,
+	MissingOperator,
+	MissingOperand,
+	MissingBracket
+};
+// offset  length -      
+struct ParseError {
+	ParseErrorKind kind = ParseErrorKind::EmptyExpression;
+	size_t offset = 0;
+	size_t length = 0;
+	std::string message;
+};
+int operandCount(OpCode op);
+int operandCount(const CompiledExpression& program, const Instruction& instruction);
+size_t maxStackDepth(const CompiledExpression& program);
+class TColumnFile;
 class TPostfix {
 private:
 	std::string infix;
 	std::string postfix;
-	std::vector<Token> tokens;
-	std::map<char, int> priority;
+	std::vector<int> postfixOrder;
+	TokenBuffer tokens;
+	CompiledExpression program;
 	std::map<std::string, double> variables;
-	void initializePriority();
+	TFunctionTable functions;
+	unsigned threads;
+	Reassociation reassociation;
+	std::pmr::memory_resource* resource;
+	std::shared_ptr<TTaskPool> pool;
 	bool isOperator(char c) const;
 	bool isBracket(char c) const;
 	bool isVariableChar(char c) const;
+	bool isDelimiter(char c) const;
 	bool isNumber(const std::string& str) const;
+	const char* scanNumber(const char* first, const char* last, double& value) const;
+	bool isFunction(const std::string& name) const;
+	int functionArity(const std::string& name) const;
+	bool report(std::vector<ParseError>& errors, bool recover, ParseErrorKind kind, size_t offset, size_t length,
+		const std::string& message) const;
+	bool report(std::vector<ParseError>& errors, bool recover, ParseErrorKind kind, size_t token,
+		const std::string& message) const;
+	std::string tokenText(size_t index) const;
+	const char* lexToken(const char* p, const char* end, TokenKind previous, TokenBuffer& output) const;
+	size_t threadCount() const;
+	TTaskPool& taskPool();
+	void lex();
+	void lexParallel(size_t count);
+	bool check(std::vector<ParseError>& errors, bool recover);
+	bool checkParallel(size_t first, size_t last, size_t count, bool& structural);
+	bool checkTokens(size_t first, size_t last, std::vector<ParseError>& errors, bool recover, bool local);
+	bool parse(ParseError& error);
+	void order();
+	void orderTokens(size_t first, size_t last, std::vector<int>& output) const;
+	void writePostfix();
+	void generate();
 public:
 	TPostfix(const std::string& infixExpr = "");
 	void setInfix(const std::string& infixExpr);
+	void setProgram(const CompiledExpression& compiled);
 	std::string GetInfix() const;
 	std::string GetPostfix();
 	void SetVariable(const std::string& name, double value);
 	double GetVariable(const std::string& name) const;
+	void registerFunction(const std::string& name, int arity, ScalarFunction scalar, unsigned flags = FUNCTION_PURE);
+	void registerFunction(const std::string& name, int arity, ScalarFunction scalar, BlockFunction block,
+		unsigned flags = FUNCTION_PURE | FUNCTION_VECTORIZABLE);
+	void setFunctions(const TFunctionTable& table);
+	const TFunctionTable& GetFunctions() const;
+	void setThreads(unsigned count);
+	unsigned GetThreads() const;
+	void setReassociation(Reassociation mode);
+	Reassociation GetReassociation() const;
+	void setMemoryResource(std::pmr::memory_resource* memory);
+	std::pmr::memory_resource* GetMemoryResource() const;
 	std::vector<Token> tokenize();
 	bool validate();
+	std::vector<ParseError> diagnose();
+	bool applyEdit(size_t offset, size_t removedLength, const std::string& insertedText);
 	std::string toPostfix();
+	const std::vector<int>& GetPostfixOrder();
+	const CompiledExpression& compile();
+	size_t GetStackDepth();
+	static TExpected<CompiledExpression, ParseError> compile(std::string_view expression,
+		const TFunctionTable& table = TFunctionTable(), Reassociation mode = Reassociation::Strict);
 	double calculate();
+	void calculateBatch(const std::map<std::string, const double*>& columns, size_t rows, double* result);
+	std::vector<double> calculateBatch(const TColumnFile& input);
+	TBatchReport calculateBatch(const std::map<std::string, const double*>& columns, size_t rows, double* result,
+		const TBatchOptions& options);
 	std::vector<Token> GetTokens() const;
 };
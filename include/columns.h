@@ -0,0 +1,39 @@
+//       
+//
+//   (  little-endian):
+//   0   char[8]   "TPCOLS01"
+//   8   uint32    
+//   12  uint32    (0)
+//   16  uint64    
+//   24    : uint32  ,  
+//          8 
+//   ...  ,  - rows  double
+#pragma once
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+class TColumnFile {
+private:
+	std::vector<std::string> names;
+	std::vector<const double*> columns;
+	std::vector<double> storage;
+	uint64_t rows;
+	void* mapping;
+	size_t mappingSize;
+	void release();
+	void parse(const unsigned char* data, size_t size, bool zeroCopy);
+public:
+	TColumnFile();
+	explicit TColumnFile(const std::string& path);
+	TColumnFile(const TColumnFile&) = delete;
+	TColumnFile& operator=(const TColumnFile&) = delete;
+	~TColumnFile();
+	void open(const std::string& path);
+	size_t GetRowCount() const;
+	size_t GetColumnCount() const;
+	const std::string& GetName(size_t index) const;
+	const double* GetColumn(size_t index) const;
+	const double* find(const std::string& name) const;
+	static void write(const std::string& path, const std::vector<std::string>& names, const std::vector<const double*>& columns, size_t rows);
+};
@@ -0,0 +1,1161 @@
+//        
+#pragma once
+#include "arithmetic.h"
+#include "pool.h"
+#include "stack.h"
+#include "vecmath.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+class TFixed64 {
+private:
+	int64_t raw;
+	static int64_t scaleProduct(int64_t a, int64_t b, int64_t divisor) {
+#if defined(__SIZEOF_INT128__)
+		return static_cast<int64_t>(static_cast<__int128>(a) * b / divisor);
+#else
+		return static_cast<int64_t>(static_cast<long double>(a) * b / divisor);
+#endif
+	}
+public:
+	static const int64_t SCALE = 100000000;
+	TFixed64() : raw(0) {}
+	explicit TFixed64(double value) : raw(std::llround(value * SCALE)) {}
+	static TFixed64 fromRaw(int64_t value) {
+		TFixed64 result;
+		result.raw = value;
+		return result;
+	}
+	int64_t GetRaw() const {
+		return raw;
+	}
+	double toDouble() const {
+		return static_cast<double>(raw) / SCALE;
+	}
+	TFixed64 operator+(TFixed64 other) const {
+		return fromRaw(raw + other.raw);
+	}
+	TFixed64 operator-(TFixed64 other) const {
+		return fromRaw(raw - other.raw);
+	}
+	TFixed64 operator*(TFixed64 other) const {
+		return fromRaw(scaleProduct(raw, other.raw, SCALE));
+	}
+	TFixed64 operator/(TFixed64 other) const {
+		return fromRaw(scaleProduct(raw, SCALE, other.raw));
+	}
+	bool operator==(TFixed64 other) const {
+		return raw == other.raw;
+	}
+	bool operator!=(TFixed64 other) const {
+		return raw != other.raw;
+	}
+	bool operator<(TFixed64 other) const {
+		return raw < other.raw;
+	}
+	bool operator<=(TFixed64 other) const {
+		return raw <= other.raw;
+	}
+	bool operator>(TFixed64 other) const {
+		return raw > other.raw;
+	}
+	bool operator>=(TFixed64 other) const {
+		return raw >= other.raw;
+	}
+};
+template<typename T>
+T applyFunction(OpCode op, T value) {
+	switch (op) {
+	case OpCode::Sin: return std::sin(value);
+	case OpCode::Cos: return std::cos(value);
+	case OpCode::Exp: return std::exp(value);
+	case OpCode::Log: return std::log(value);
+	case OpCode::Sqrt: return std::sqrt(value);
+	case OpCode::Abs: return std::fabs(value);
+	default:
+		throw std::invalid_argument("Unknown function");
+	}
+}
+const int POW_INT_LIMIT = 16;
+template<typename T>
+struct TNumericTraits {
+	static T fromDouble(double value) {
+		return static_cast<T>(value);
+	}
+	static T power(T a, T b) {
+		return std::pow(a, b);
+	}
+	static double toDouble(T value) {
+		return static_cast<double>(value);
+	}
+	static T reciprocal(T value) {
+		return T(1) / value;
+	}
+	static T function(OpCode op, T value) {
+		return applyFunction<T>(op, value);
+	}
+	static bool isSmallInteger(T value, int& exponent) {
+		if (value != std::trunc(value) || std::fabs(value) > POW_INT_LIMIT) {
+			return false;
+		}
+		exponent = static_cast<int>(value);
+		return true;
+	}
+};
+template<>
+struct TNumericTraits<TFixed64> {
+	static TFixed64 fromDouble(double value) {
+		return TFixed64(value);
+	}
+	static TFixed64 power(TFixed64 a, TFixed64 b) {
+		return TFixed64(std::pow(a.toDouble(), b.toDouble()));
+	}
+	static double toDouble(TFixed64 value) {
+		return value.toDouble();
+	}
+	static TFixed64 reciprocal(TFixed64 value) {
+		if (value == TFixed64()) {
+			throw std::runtime_error("Division by zero");
+		}
+		return TFixed64(1.0) / value;
+	}
+	static TFixed64 function(OpCode op, TFixed64 value) {
+		if (op == OpCode::Abs) {
+			return value.GetRaw() < 0 ? TFixed64() - value : value;
+		}
+		return TFixed64(applyFunction<double>(op, value.toDouble()));
+	}
+	static bool isSmallInteger(TFixed64 value, int& exponent) {
+		int64_t whole = value.GetRaw() / TFixed64::SCALE;
+		if (value.GetRaw() % TFixed64::SCALE != 0 || whole > POW_INT_LIMIT || whole < -POW_INT_LIMIT) {
+			return false;
+		}
+		exponent = static_cast<int>(whole);
+		return true;
+	}
+};
+//      :  |n| <= POW_INT_LIMIT
+//    2*log2|n|  (    n < 0), 
+//   double   std::pow     2*log2|n| + 1 ulp;
+// x^2  x^-1  , x^3 -     2 ulp
+template<typename T>
+T powInteger(T base, int exponent) {
+	unsigned n = exponent < 0 ? 0u - static_cast<unsigned>(exponent) : static_cast<unsigned>(exponent);
+	T result = TNumericTraits<T>::fromDouble(1.0);
+	while (n != 0) {
+		if (n & 1u) {
+			result = result * base;
+		}
+		n >>= 1;
+		if (n != 0) {
+			base = base * base;
+		}
+	}
+	return exponent < 0 ? TNumericTraits<T>::reciprocal(result) : result;
+}
+template<typename T>
+T powerValue(T a, T b) {
+	int exponent;
+	if (TNumericTraits<T>::isSmallInteger(b, exponent)) {
+		return powInteger<T>(a, exponent);
+	}
+	return TNumericTraits<T>::power(a, b);
+}
+template<typename T>
+void powIntegerBlock(const T* a, int exponent, size_t n, T* out) {
+	switch (exponent) {
+	case 2:
+		for (size_t i = 0; i < n; i++) out[i] = a[i] * a[i];
+		break;
+	case 3:
+		for (size_t i = 0; i < n; i++) out[i] = a[i] * a[i] * a[i];
+		break;
+	default:
+		for (size_t i = 0; i < n; i++) out[i] = powInteger<T>(a[i], exponent);
+		break;
+	}
+}
+template<typename T>
+void functionBlock(OpCode op, const T* a, size_t n, T* out) {
+	for (size_t i = 0; i < n; i++) out[i] = TNumericTraits<T>::function(op, a[i]);
+}
+template<>
+inline void functionBlock<double>(OpCode op, const double* a, size_t n, double* out) {
+	switch (op) {
+	case OpCode::Sin: sinBlock(a, n, out); break;
+	case OpCode::Cos: cosBlock(a, n, out); break;
+	case OpCode::Exp: expBlock(a, n, out); break;
+	case OpCode::Log: logBlock(a, n, out); break;
+	case OpCode::Sqrt: sqrtBlock(a, n, out); break;
+	case OpCode::Abs: absBlock(a, n, out); break;
+	default:
+		throw std::invalid_argument("Unknown function");
+	}
+}
+template<typename T>
+void callRows(const TNativeFunction& function, const std::vector<const T*>& arguments, size_t n, T* out) {
+	std::vector<double> values(arguments.size());
+	for (size_t i = 0; i < n; i++) {
+		for (size_t j = 0; j < arguments.size(); j++) {
+			values[j] = TNumericTraits<T>::toDouble(arguments[j][i]);
+		}
+		out[i] = TNumericTraits<T>::fromDouble(function.scalar(values.data()));
+	}
+}
+template<typename T>
+void callBlock(const TNativeFunction& function, const std::vector<const T*>& arguments, size_t n, T* out) {
+	callRows<T>(function, arguments, n, out);
+}
+template<>
+inline void callBlock<double>(const TNativeFunction& function, const std::vector<const double*>& arguments, size_t n, double* out) {
+	if (function.flags & FUNCTION_VECTORIZABLE) {
+		function.block(arguments.data(), n, out);
+	}
+	else {
+		callRows<double>(function, arguments, n, out);
+	}
+}
+//      - 1 ()  0 (),
+//      
+template<typename T>
+T truthValue(bool value) {
+	return TNumericTraits<T>::fromDouble(value ? 1.0 : 0.0);
+}
+template<typename T>
+void selectBlock(const T* condition, const T* a, const T* b, size_t n, T* out) {
+	const T zero = T();
+	for (size_t i = 0; i < n; i++) {
+		T x = a[i];
+		T y = b[i];
+		out[i] = condition[i] != zero ? x : y;
+	}
+}
+//   n- :       ,
+//    ;       
+template<typename T>
+T pairwiseReduce(OpCode op, T* values, size_t n) {
+	for (size_t width = 1; width < n; width *= 2) {
+		for (size_t i = 0; i + width < n; i += 2 * width) {
+			values[i] = op == OpCode::Product ? values[i] * values[i + width] : values[i] + values[i + width];
+		}
+	}
+	return values[0];
+}
+template<typename T>
+T magnitude(T value) {
+	return value < T() ? T() - value : value;
+}
+//  :      compensation
+template<typename T>
+T compensatedSum(const T* values, size_t n) {
+	T sum = values[0];
+	T compensation = T();
+	for (size_t i = 1; i < n; i++) {
+		T next = sum + values[i];
+		if (magnitude(sum) >= magnitude(values[i])) {
+			compensation = compensation + ((sum - next) + values[i]);
+		}
+		else {
+			compensation = compensation + ((values[i] - next) + sum);
+		}
+		sum = next;
+	}
+	return sum + compensation;
+}
+const size_t BATCH_BLOCK = 256;
+inline size_t evaluationDepth(const CompiledExpression& program) {
+	return program.stackDepth != 0 ? program.stackDepth : maxStackDepth(program);
+}
+//       ,         then,
+//          
+inline size_t batchDepth(const CompiledExpression& program) {
+	const std::vector<Instruction>& code = program.code;
+	std::vector<size_t> ends;
+	size_t nesting = 0;
+	for (size_t pc = 0; pc < code.size(); pc++) {
+		while (!ends.empty() && ends.back() <= pc) {
+			ends.pop_back();
+		}
+		if (code[pc].op == OpCode::JumpIfZero) {
+			size_t target = static_cast<size_t>(code[pc].arg);
+			ends.push_back(target > pc && target <= code.size() ? static_cast<size_t>(code[target - 1].arg) : code.size());
+			nesting = std::max(nesting, ends.size());
+		}
+	}
+	return evaluationDepth(program) + 2 * nesting;
+}
+template<typename T>
+std::vector<T> bindVariables(const CompiledExpression& program, const std::map<std::string, T>& variables) {
+	std::vector<T> values(program.names.size());
+	for (size_t i = 0; i < program.names.size(); i++) {
+		auto it = variables.find(program.names[i]);
+		if (it == variables.end()) {
+			throw std::invalid_argument("Underfined variable: " + program.names[i]);
+		}
+		values[i] = it->second;
+	}
+	return values;
+}
+template<typename T>
+bool tryBindColumns(const CompiledExpression& program, const std::map<std::string, const T*>& columns,
+	const std::map<std::string, T>& variables, std::vector<const T*>& sources, std::vector<T>& scalars, std::string& missing) {
+	sources.assign(program.names.size(), nullptr);
+	scalars.assign(program.names.size(), T());
+	for (size_t i = 0; i < program.names.size(); i++) {
+		auto column = columns.find(program.names[i]);
+		if (column != columns.end()) {
+			sources[i] = column->second;
+			continue;
+		}
+		auto it = variables.find(program.names[i]);
+		if (it == variables.end()) {
+			missing = program.names[i];
+			return false;
+		}
+		scalars[i] = it->second;
+	}
+	return true;
+}
+template<typename T>
+void bindColumns(const CompiledExpression& program, const std::map<std::string, const T*>& columns,
+	const std::map<std::string, T>& variables, std::vector<const T*>& sources, std::vector<T>& scalars) {
+	std::string missing;
+	if (!tryBindColumns<T>(program, columns, variables, sources, scalars, missing)) {
+		throw std::invalid_argument("Underfined variable: " + missing);
+	}
+}
+inline bool tryBindFunctions(const CompiledExpression& program, const TFunctionTable& table,
+	std::vector<const TNativeFunction*>& natives, std::string& missing) {
+	natives.assign(program.functions.size(), nullptr);
+	for (size_t i = 0; i < program.functions.size(); i++) {
+		natives[i] = table.find(program.functions[i].name);
+		if (natives[i] == nullptr || natives[i]->arity != program.functions[i].arity) {
+			missing = program.functions[i].name;
+			return false;
+		}
+	}
+	return true;
+}
+inline std::vector<const TNativeFunction*> bindFunctions(const CompiledExpression& program, const TFunctionTable& table) {
+	std::vector<const TNativeFunction*> natives;
+	std::string missing;
+	if (!tryBindFunctions(program, table, natives, missing)) {
+		throw std::invalid_argument("Unknown function: " + missing);
+	}
+	return natives;
+}
+//         NaN (   NaN - )
+//     BATCH_DIVISION_BY_ZERO;     
+//  ,        IEEE
+template<typename T>
+T errorValue() {
+	if constexpr (std::numeric_limits<T>::has_quiet_NaN) {
+		return std::numeric_limits<T>::quiet_NaN();
+	}
+	else {
+		return T();
+	}
+}
+template<typename T>
+bool ieeeDivision(const TBatchOptions& options) {
+	return !options.divisionByZeroIsError && std::numeric_limits<T>::has_infinity;
+}
+template<typename T>
+T divideByZero(T a, const TBatchOptions& options, unsigned char& error) {
+	if constexpr (std::numeric_limits<T>::has_infinity) {
+		if (!options.divisionByZeroIsError) {
+			return a / T();
+		}
+	}
+	error |= BATCH_DIVISION_BY_ZERO;
+	return errorValue<T>();
+}
+template<typename T>
+unsigned char nonFiniteFlags(T value) {
+	if constexpr (std::numeric_limits<T>::has_infinity) {
+		const T infinity = std::numeric_limits<T>::infinity();
+		return static_cast<unsigned char>((value != value) * BATCH_NOT_A_NUMBER |
+			(value == infinity || value == -infinity) * BATCH_INFINITY);
+	}
+	else {
+		return 0;
+	}
+}
+inline void countBatchErrors(TBatchReport& report) {
+	for (unsigned char flags : report.rowErrors) {
+		report.divisionByZero += (flags & BATCH_DIVISION_BY_ZERO) != 0;
+		report.notANumber += (flags & BATCH_NOT_A_NUMBER) != 0;
+		report.infinity += (flags & BATCH_INFINITY) != 0;
+		report.failedRows += flags != 0;
+	}
+}
+template<typename T>
+void evaluateRange(const CompiledExpression& program, size_t begin, size_t end, const std::vector<T>& values,
+	const std::vector<const TNativeFunction*>& natives, TPmrStack<T>& stack,
+	const TBatchOptions* options = nullptr, unsigned char* error = nullptr) {
+	std::vector<double> arguments;
+	std::vector<T> operands;
+	size_t pc = begin;
+	while (pc < end) {
+		const Instruction& instruction = program.code[pc++];
+		if (instruction.op == OpCode::Number) {
+			stack.push(TNumericTraits<T>::fromDouble(program.constants[instruction.arg]));
+			continue;
+		}
+		if (instruction.op == OpCode::Variable) {
+			stack.push(values[instruction.arg]);
+			continue;
+		}
+		if (instruction.op == OpCode::Jump) {
+			pc = instruction.arg;
+			continue;
+		}
+		if (instruction.op == OpCode::JumpIfZero || instruction.op == OpCode::AndJump || instruction.op == OpCode::OrJump) {
+			if (stack.isEmpty()) {
+				throw std::invalid_argument("Not enough operands for operator");
+			}
+			if (instruction.op == OpCode::JumpIfZero) {
+				if (stack.pop_unchecked() == T()) {
+					pc = instruction.arg;
+				}
+				continue;
+			}
+			bool result = instruction.op == OpCode::OrJump;
+			if ((stack.peek() != T()) == result) {
+				stack.pop_unchecked();
+				stack.push_unchecked(truthValue<T>(result));
+				pc = instruction.arg;
+			}
+			continue;
+		}
+		if (instruction.op == OpCode::Call) {
+			const TNativeFunction& function = *natives[instruction.arg];
+			if (stack.GetSize() < function.arity) {
+				throw std::invalid_argument("Not enough operands for operator");
+			}
+			arguments.resize(function.arity);
+			for (int j = function.arity - 1; j >= 0; j--) {
+				arguments[j] = TNumericTraits<T>::toDouble(stack.pop_unchecked());
+			}
+			stack.push(TNumericTraits<T>::fromDouble(function.scalar(arguments.data())));
+			continue;
+		}
+		if (instruction.op == OpCode::Sum || instruction.op == OpCode::Product || instruction.op == OpCode::CompensatedSum) {
+			size_t count = static_cast<size_t>(instruction.arg);
+			if (instruction.arg < 2 || static_cast<size_t>(stack.GetSize()) < count) {
+				throw std::invalid_argument("Not enough operands for operator");
+			}
+			operands.resize(count);
+			for (size_t j = count; j-- > 0;) {
+				operands[j] = stack.pop_unchecked();
+			}
+			stack.push_unchecked(instruction.op == OpCode::CompensatedSum ? compensatedSum<T>(operands.data(), count) :
+				pairwiseReduce<T>(instruction.op, operands.data(), count));
+			continue;
+		}
+		if (operandCount(instruction.op) == 1) {
+			if (stack.isEmpty()) {
+				throw std::invalid_argument("Not enough operands for operator");
+			}
+			T a = stack.pop_unchecked();
+			if (instruction.op == OpCode::PowInt) {
+				stack.push_unchecked(powInteger<T>(a, instruction.arg));
+			}
+			else if (instruction.op == OpCode::Not) {
+				stack.push_unchecked(truthValue<T>(a == T()));
+			}
+			else {
+				stack.push_unchecked(TNumericTraits<T>::function(instruction.op, a));
+			}
+			continue;
+		}
+		if (instruction.op == OpCode::Select) {
+			if (stack.GetSize() < 3) {
+				throw std::invalid_argument("Not enough operands for operator");
+			}
+			T b = stack.pop_unchecked();
+			T a = stack.pop_unchecked();
+			T condition = stack.pop_unchecked();
+			stack.push_unchecked(condition != T() ? a : b);
+			continue;
+		}
+		if (stack.GetSize() < 2) {
+			throw std::invalid_argument("Not enough operands for operator");
+		}
+		T b = stack.pop_unchecked();
+		T a = stack.pop_unchecked();
+		T result = T();
+		switch (instruction.op) {
+		case OpCode::Add:
+			result = a + b; break;
+		case OpCode::Sub:
+			result = a - b; break;
+		case OpCode::Mul:
+			result = a * b; break;
+		case OpCode::Div:
+			if (b == T()) {
+				if (error == nullptr) throw std::runtime_error("Division by zero");
+				result = divideByZero<T>(a, *options, *error);
+				break;
+			}
+			result = a / b;
+			break;
+		case OpCode::Pow:
+			result = powerValue<T>(a, b);
+			break;
+		case OpCode::Min:
+			result = b < a ? b : a;
+			break;
+		case OpCode::Max:
+			result = a < b ? b : a;
+			break;
+		case OpCode::Less:
+			result = truthValue<T>(a < b); break;
+		case OpCode::LessEqual:
+			result = truthValue<T>(a <= b); break;
+		case OpCode::Greater:
+			result = truthValue<T>(a > b); break;
+		case OpCode::GreaterEqual:
+			result = truthValue<T>(a >= b); break;
+		case OpCode::Equal:
+			result = truthValue<T>(a == b); break;
+		case OpCode::NotEqual:
+			result = truthValue<T>(a != b); break;
+		case OpCode::And:
+			result = truthValue<T>(a != T() && b != T()); break;
+		case OpCode::Or:
+			result = truthValue<T>(a != T() || b != T()); break;
+		default:
+			throw std::invalid_argument("Unknown operator");
+		}
+		stack.push_unchecked(result);
+	}
+}
+template<typename T>
+T evaluateProgram(const CompiledExpression& program, const std::vector<T>& values,
+	const std::vector<const TNativeFunction*>& natives, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+	TPmrStack<T> stack(evaluationDepth(program), resource);
+	evaluateRange<T>(program, 0, program.code.size(), values, natives, stack);
+	if (stack.GetSize() != 1) {
+		throw std::invalid_argument("Invalid expression");
+	}
+	return stack.pop();
+}
+//    -   [begin, end),     
+//   ;      
+struct TEvaluationNode {
+	size_t begin;
+	size_t end;
+	size_t first;
+	size_t count;
+};
+// false,       (   )
+inline bool buildEvaluationTree(const CompiledExpression& program, std::vector<TEvaluationNode>& nodes, std::vector<size_t>& children,
+	size_t& root) {
+	const std::vector<Instruction>& code = program.code;
+	std::vector<size_t> roots;
+	nodes.clear();
+	children.clear();
+	nodes.reserve(code.size());
+	children.reserve(code.size());
+	size_t pc = 0;
+	while (pc < code.size()) {
+		const Instruction& instruction = code[pc];
+		TEvaluationNode node = { pc, pc + 1, children.size(), 0 };
+		if (instruction.op == OpCode::JumpIfZero || instruction.op == OpCode::AndJump || instruction.op == OpCode::OrJump) {
+			size_t target = static_cast<size_t>(instruction.arg);
+			if (roots.empty() || target <= pc + 1 || target > code.size()) {
+				return false;
+			}
+			if (instruction.op == OpCode::JumpIfZero) {
+				const Instruction& jump = code[target - 1];
+				if (jump.op != OpCode::Jump || static_cast<size_t>(jump.arg) < target || static_cast<size_t>(jump.arg) > code.size()) {
+					return false;
+				}
+				target = jump.arg;
+			}
+			node.begin = nodes[roots.back()].begin;
+			node.end = target;
+			roots.pop_back();
+		}
+		else {
+			int operands = operandCount(program, instruction);
+			if (operands < 0 || static_cast<size_t>(operands) > roots.size()) {
+				return false;
+			}
+			node.count = operands;
+			if (node.count > 0) {
+				node.begin = nodes[roots[roots.size() - node.count]].begin;
+				children.insert(children.end(), roots.end() - node.count, roots.end());
+				roots.resize(roots.size() - node.count);
+			}
+		}
+		pc = node.end;
+		roots.push_back(nodes.size());
+		nodes.push_back(node);
+	}
+	if (roots.size() != 1) {
+		return false;
+	}
+	root = roots.back();
+	return true;
+}
+//     ;    ((t1 + t2) + t3) + ...
+//   ,       ,
+//      
+template<typename T>
+class TParallelEvaluator {
+private:
+	const CompiledExpression& program;
+	const std::vector<T>& values;
+	const std::vector<const TNativeFunction*>& natives;
+	TTaskPool& pool;
+	size_t grain;
+	std::pmr::memory_resource* resource;
+	std::vector<TEvaluationNode> nodes;
+	std::vector<size_t> children;
+	size_t size(size_t node) const {
+		return nodes[node].end - nodes[node].begin;
+	}
+	//    ,       
+	T serial(size_t node) const {
+		TPmrStack<T> stack(16);
+		evaluateRange<T>(program, nodes[node].begin, nodes[node].end, values, natives, stack);
+		return stack.pop();
+	}
+	T evaluate(size_t node) {
+		if (size(node) <= grain || nodes[node].count == 0) {
+			return serial(node);
+		}
+		std::vector<size_t> spine;
+		size_t bottom = node;
+		while (size(bottom) > grain && nodes[bottom].count > 0) {
+			spine.push_back(bottom);
+			const TEvaluationNode& current = nodes[bottom];
+			size_t largest = children[current.first];
+			for (size_t j = 1; j < current.count; j++) {
+				if (size(children[current.first + j]) > size(largest)) {
+					largest = children[current.first + j];
+				}
+			}
+			bottom = largest;
+		}
+		std::vector<size_t> sides(1, bottom);
+		for (size_t s = 0; s < spine.size(); s++) {
+			size_t next = s + 1 < spine.size() ? spine[s + 1] : bottom;
+			const TEvaluationNode& current = nodes[spine[s]];
+			for (size_t j = 0; j < current.count; j++) {
+				if (children[current.first + j] != next) {
+					sides.push_back(children[current.first + j]);
+				}
+			}
+		}
+		std::vector<T> results(sides.size());
+		{
+			TTaskGroup group(pool);
+			size_t batch = 0;
+			size_t batchSize = 0;
+			for (size_t k = 0; k <= sides.size(); k++) {
+				bool large = k < sides.size() && size(sides[k]) > grain;
+				if (k == sides.size() || large || batchSize >= grain) {
+					if (batch < k) {
+						group.spawn([this, &sides, &results, batch, k] {
+							for (size_t j = batch; j < k; j++) {
+								results[j] = serial(sides[j]);
+							}
+						});
+					}
+					batch = k;
+					batchSize = 0;
+				}
+				if (large) {
+					group.spawn([this, &sides, &results, k] {
+						results[k] = evaluate(sides[k]);
+					});
+					batch = k + 1;
+				}
+				else if (k < sides.size()) {
+					batchSize += size(sides[k]);
+				}
+			}
+			group.wait();
+		}
+		TPmrStack<T> stack(16, resource);
+		T accumulator = results[0];
+		size_t side = sides.size();
+		for (size_t s = spine.size(); s-- > 0;) {
+			size_t next = s + 1 < spine.size() ? spine[s + 1] : bottom;
+			const TEvaluationNode& current = nodes[spine[s]];
+			size_t used = 0;
+			for (size_t j = 0; j < current.count; j++) {
+				used += children[current.first + j] != next ? 1 : 0;
+			}
+			side -= used;
+			for (size_t j = 0, k = side; j < current.count; j++) {
+				stack.push(children[current.first + j] == next ? accumulator : results[k++]);
+			}
+			evaluateRange<T>(program, current.end - 1, current.end, values, natives, stack);
+			accumulator = stack.pop();
+		}
+		return accumulator;
+	}
+public:
+	TParallelEvaluator(const CompiledExpression& compiled, const std::vector<T>& bound,
+		const std::vector<const TNativeFunction*>& callables, TTaskPool& taskPool, size_t grainSize,
+		std::pmr::memory_resource* memory)
+		: program(compiled), values(bound), natives(callables), pool(taskPool), grain(grainSize), resource(memory) {}
+	T run() {
+		size_t root = 0;
+		if (!buildEvaluationTree(program, nodes, children, root)) {
+			return evaluateProgram<T>(program, values, natives, resource);
+		}
+		return evaluate(root);
+	}
+};
+//  ,      PARALLEL_EVALUATION_MIN 
+const size_t PARALLEL_EVALUATION_MIN = 1 << 14;
+const size_t PARALLEL_EVALUATION_GRAIN = 1 << 11;
+template<typename T>
+T evaluateProgramParallel(const CompiledExpression& program, const std::vector<T>& values,
+	const std::vector<const TNativeFunction*>& natives, TTaskPool& pool,
+	std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+	bool pure = std::all_of(natives.begin(), natives.end(), [](const TNativeFunction* function) {
+		return (function->flags & FUNCTION_PURE) != 0;
+	});
+	if (!pure || program.code.size() < PARALLEL_EVALUATION_MIN) {
+		return evaluateProgram<T>(program, values, natives, resource);
+	}
+	return TParallelEvaluator<T>(program, values, natives, pool, PARALLEL_EVALUATION_GRAIN, resource).run();
+}
+//    ,     1/BATCH_SPARSE_DIVISOR
+//   ,  ;     
+// ,   ,     
+//     
+const size_t BATCH_SPARSE_DIVISOR = 16;
+template<typename T>
+class TBatchRunner {
+private:
+	const CompiledExpression& program;
+	const std::vector<const T*>& sources;
+	const std::vector<T>& scalars;
+	const std::vector<const TNativeFunction*>& natives;
+	std::vector<T> scratch;
+	TPmrStack<const T*> stack;
+	std::vector<const T*> arguments;
+	std::vector<T> callResult;
+	std::vector<T> compensation;
+	std::vector<std::vector<unsigned char>> masks;
+	std::vector<T> rowValues;
+	TPmrStack<T> rowStack;
+	const TBatchOptions* options;
+	unsigned char* errors;
+	std::vector<unsigned char> allLanes;
+	size_t base;
+	size_t n;
+	T* slot(int depth) {
+		return &scratch[depth * BATCH_BLOCK];
+	}
+	unsigned char* levelMasks(size_t level) {
+		if (masks.size() <= level) {
+			masks.resize(level + 1);
+		}
+		if (masks[level].empty()) {
+			masks[level].resize(2 * BATCH_BLOCK);
+		}
+		return masks[level].data();
+	}
+	T evaluateRow(size_t begin, size_t end, size_t lane) {
+		for (size_t j = 0; j < rowValues.size(); j++) {
+			rowValues[j] = sources[j] != nullptr ? sources[j][base + lane] : scalars[j];
+		}
+		rowStack.clear();
+		evaluateRange<T>(program, begin, end, rowValues, natives, rowStack, options, errors != nullptr ? errors + base + lane : nullptr);
+		return rowStack.pop();
+	}
+	void reduce(OpCode op, size_t count) {
+		arguments.resize(count);
+		for (size_t j = count; j-- > 0;) {
+			arguments[j] = stack.pop();
+		}
+		size_t depth = stack.GetSize();
+		T* out = slot(depth);
+		if (op == OpCode::CompensatedSum) {
+			compensation.assign(n, T());
+			if (arguments[0] != out) {
+				std::copy(arguments[0], arguments[0] + n, out);
+			}
+			for (size_t k = 1; k < count; k++) {
+				const T* a = arguments[k];
+				for (size_t i = 0; i < n; i++) {
+					T next = out[i] + a[i];
+					compensation[i] = compensation[i] + (magnitude(out[i]) >= magnitude(a[i]) ? (out[i] - next) + a[i] : (a[i] - next) + out[i]);
+					out[i] = next;
+				}
+			}
+			for (size_t i = 0; i < n; i++) out[i] = out[i] + compensation[i];
+		}
+		else {
+			for (size_t width = 1; width < count; width *= 2) {
+				for (size_t k = 0; k + width < count; k += 2 * width) {
+					const T* a = arguments[k];
+					const T* b = arguments[k + width];
+					T* target = slot(depth + k);
+					if (op == OpCode::Product) {
+						for (size_t i = 0; i < n; i++) target[i] = a[i] * b[i];
+					}
+					else {
+						for (size_t i = 0; i < n; i++) target[i] = a[i] + b[i];
+					}
+					arguments[k] = target;
+				}
+			}
+		}
+		stack.push(out);
+	}
+	T* ownTop() {
+		const T* top = stack.pop();
+		T* out = slot(stack.GetSize());
+		if (top != out) {
+			std::copy(top, top + n, out);
+		}
+		stack.push(out);
+		return out;
+	}
+	void branch(size_t thenBegin, size_t elseBegin, size_t end, const unsigned char* active, size_t level) {
+		size_t thenEnd = elseBegin - 1;
+		unsigned char* taken = levelMasks(level);
+		unsigned char* skipped = taken + BATCH_BLOCK;
+		const T* condition = stack.peek();
+		const T zero = T();
+		size_t activeCount = 0;
+		size_t takenCount = 0;
+		for (size_t i = 0; i < n; i++) {
+			unsigned char on = active == nullptr ? 1 : active[i];
+			unsigned char yes = condition[i] != zero;
+			taken[i] = on & yes;
+			skipped[i] = on & (yes ^ 1);
+			activeCount += on;
+			takenCount += taken[i];
+		}
+		size_t skippedCount = activeCount - takenCount;
+		size_t sparse = activeCount / BATCH_SPARSE_DIVISOR;
+		if (skippedCount == 0 || takenCount == 0) {
+			stack.pop();
+			if (skippedCount == 0) {
+				run(thenBegin, thenEnd, active, level + 1);
+			}
+			else {
+				run(elseBegin, end, active, level + 1);
+			}
+		}
+		else if (takenCount <= sparse || skippedCount <= sparse) {
+			bool fewTaken = takenCount <= sparse;
+			stack.pop();
+			if (fewTaken) {
+				run(elseBegin, end, skipped, level + 1);
+			}
+			else {
+				run(thenBegin, thenEnd, taken, level + 1);
+			}
+			T* out = ownTop();
+			const unsigned char* lanes = fewTaken ? taken : skipped;
+			for (size_t i = 0; i < n; i++) {
+				if (lanes[i]) {
+					out[i] = fewTaken ? evaluateRow(thenBegin, thenEnd, i) : evaluateRow(elseBegin, end, i);
+				}
+			}
+		}
+		else {
+			run(thenBegin, thenEnd, taken, level + 1);
+			run(elseBegin, end, skipped, level + 1);
+			const T* b = stack.pop();
+			const T* a = stack.pop();
+			stack.pop();
+			T* out = slot(stack.GetSize());
+			selectBlock<T>(condition, a, b, n, out);
+			stack.push(out);
+		}
+	}
+	void logical(bool isAnd, size_t begin, size_t end, const unsigned char* active, size_t level) {
+		unsigned char* needed = levelMasks(level);
+		const T* a = stack.peek();
+		const T zero = T();
+		size_t activeCount = 0;
+		size_t neededCount = 0;
+		for (size_t i = 0; i < n; i++) {
+			unsigned char on = active == nullptr ? 1 : active[i];
+			needed[i] = on & ((a[i] != zero) == isAnd);
+			activeCount += on;
+			neededCount += needed[i];
+		}
+		if (neededCount == activeCount) {
+			run(begin, end, active, level + 1);
+		}
+		else if (neededCount <= activeCount / BATCH_SPARSE_DIVISOR) {
+			stack.pop();
+			T* out = slot(stack.GetSize());
+			T shortcut = truthValue<T>(!isAnd);
+			std::fill(out, out + n, shortcut);
+			for (size_t i = 0; i < n; i++) {
+				if (needed[i]) {
+					out[i] = truthValue<T>(evaluateRow(begin, end - 1, i) != zero);
+				}
+			}
+			stack.push(out);
+		}
+		else {
+			run(begin, end, needed, level + 1);
+		}
+	}
+	void run(size_t begin, size_t end, const unsigned char* active, size_t level) {
+		const T zero = T();
+		const T one = TNumericTraits<T>::fromDouble(1.0);
+		size_t pc = begin;
+		while (pc < end) {
+			const Instruction& instruction = program.code[pc++];
+			T* out = slot(stack.GetSize());
+			if (instruction.op == OpCode::Number || instruction.op == OpCode::Variable) {
+				if (instruction.op == OpCode::Variable && sources[instruction.arg] != nullptr) {
+					stack.push(sources[instruction.arg] + base);
+					continue;
+				}
+				T value = instruction.op == OpCode::Number ? TNumericTraits<T>::fromDouble(program.constants[instruction.arg]) : scalars[instruction.arg];
+				std::fill(out, out + n, value);
+				stack.push(out);
+				continue;
+			}
+			if (instruction.op == OpCode::JumpIfZero) {
+				size_t elseBegin = instruction.arg;
+				size_t finish = program.code[elseBegin - 1].arg;
+				branch(pc, elseBegin, finish, active, level);
+				pc = finish;
+				continue;
+			}
+			if (instruction.op == OpCode::AndJump || instruction.op == OpCode::OrJump) {
+				logical(instruction.op == OpCode::AndJump, pc, instruction.arg, active, level);
+				pc = instruction.arg;
+				continue;
+			}
+			if (instruction.op == OpCode::Call) {
+				const TNativeFunction& function = *natives[instruction.arg];
+				arguments.resize(function.arity);
+				for (int j = function.arity - 1; j >= 0; j--) {
+					arguments[j] = stack.pop();
+				}
+				callBlock<T>(function, arguments, n, callResult.data());
+				out = slot(stack.GetSize());
+				std::copy(callResult.begin(), callResult.begin() + n, out);
+				stack.push(out);
+				continue;
+			}
+			if (instruction.op == OpCode::Sum || instruction.op == OpCode::Product || instruction.op == OpCode::CompensatedSum) {
+				reduce(instruction.op, instruction.arg);
+				continue;
+			}
+			if (operandCount(instruction.op) == 1) {
+				const T* a = stack.pop();
+				out = slot(stack.GetSize());
+				if (instruction.op == OpCode::PowInt) {
+					powIntegerBlock<T>(a, instruction.arg, n, out);
+				}
+				else if (instruction.op == OpCode::Not) {
+					for (size_t i = 0; i < n; i++) out[i] = a[i] == zero ? one : zero;
+				}
+				else {
+					functionBlock<T>(instruction.op, a, n, out);
+				}
+				stack.push(out);
+				continue;
+			}
+			if (instruction.op == OpCode::Select) {
+				const T* b = stack.pop();
+				const T* a = stack.pop();
+				const T* condition = stack.pop();
+				out = slot(stack.GetSize());
+				selectBlock<T>(condition, a, b, n, out);
+				stack.push(out);
+				continue;
+			}
+			const T* b = stack.pop();
+			const T* a = stack.pop();
+			out = slot(stack.GetSize());
+			switch (instruction.op) {
+			case OpCode::Add:
+				for (size_t i = 0; i < n; i++) out[i] = a[i] + b[i];
+				break;
+			case OpCode::Sub:
+				for (size_t i = 0; i < n; i++) out[i] = a[i] - b[i];
+				break;
+			case OpCode::Mul:
+				for (size_t i = 0; i < n; i++) out[i] = a[i] * b[i];
+				break;
+			case OpCode::Div:
+				if (errors == nullptr) {
+					for (size_t i = 0; i < n; i++) {
+						if (b[i] == zero && (active == nullptr || active[i])) throw std::runtime_error("Division by zero");
+					}
+					for (size_t i = 0; i < n; i++) out[i] = a[i] / b[i];
+				}
+				else if (ieeeDivision<T>(*options)) {
+					for (size_t i = 0; i < n; i++) out[i] = a[i] / b[i];
+				}
+				else {
+					const T bad = errorValue<T>();
+					const unsigned char* lanes = active != nullptr ? active : allLanes.data();
+					unsigned char* flags = errors + base;
+					const size_t count = n;
+					for (size_t i = 0; i < count; i++) flags[i] |= static_cast<unsigned char>(((b[i] == zero) & lanes[i]) * BATCH_DIVISION_BY_ZERO);
+					if constexpr (std::numeric_limits<T>::has_infinity) {
+						for (size_t i = 0; i < count; i++) out[i] = a[i] / b[i];
+					}
+					else {
+						for (size_t i = 0; i < count; i++) out[i] = a[i] / (b[i] == zero ? one : b[i]);
+					}
+					for (size_t i = 0; i < count; i++) {
+						T value = out[i];
+						out[i] = b[i] == zero ? bad : value;
+					}
+				}
+				break;
+			case OpCode::Pow:
+				for (size_t i = 0; i < n; i++) out[i] = powerValue<T>(a[i], b[i]);
+				break;
+			case OpCode::Min:
+				for (size_t i = 0; i < n; i++) out[i] = b[i] < a[i] ? b[i] : a[i];
+				break;
+			case OpCode::Max:
+				for (size_t i = 0; i < n; i++) out[i] = a[i] < b[i] ? b[i] : a[i];
+				break;
+			case OpCode::Less:
+				for (size_t i = 0; i < n; i++) out[i] = a[i] < b[i] ? one : zero;
+				break;
+			case OpCode::LessEqual:
+				for (size_t i = 0; i < n; i++) out[i] = a[i] <= b[i] ? one : zero;
+				break;
+			case OpCode::Greater:
+				for (size_t i = 0; i < n; i++) out[i] = a[i] > b[i] ? one : zero;
+				break;
+			case OpCode::GreaterEqual:
+				for (size_t i = 0; i < n; i++) out[i] = a[i] >= b[i] ? one : zero;
+				break;
+			case OpCode::Equal:
+				for (size_t i = 0; i < n; i++) out[i] = a[i] == b[i] ? one : zero;
+				break;
+			case OpCode::NotEqual:
+				for (size_t i = 0; i < n; i++) out[i] = a[i] != b[i] ? one : zero;
+				break;
+			case OpCode::And:
+				for (size_t i = 0; i < n; i++) out[i] = (a[i] != zero) & (b[i] != zero) ? one : zero;
+				break;
+			case OpCode::Or:
+				for (size_t i = 0; i < n; i++) out[i] = (a[i] != zero) | (b[i] != zero) ? one : zero;
+				break;
+			default:
+				throw std::invalid_argument("Unknown operator");
+			}
+			stack.push(out);
+		}
+	}
+public:
+	TBatchRunner(const CompiledExpression& compiled, const std::vector<const T*>& columnSources,
+		const std::vector<T>& columnScalars, const std::vector<const TNativeFunction*>& boundNatives,
+		const TBatchOptions* batchOptions, unsigned char* rowErrors, std::pmr::memory_resource* resource)
+		: program(compiled), sources(columnSources), scalars(columnScalars), natives(boundNatives),
+		scratch((batchDepth(compiled) + 1) * BATCH_BLOCK), stack(batchDepth(compiled), resource),
+		callResult(compiled.functions.empty() ? 0 : BATCH_BLOCK), rowValues(compiled.names.size()),
+		rowStack(evaluationDepth(compiled), resource), options(batchOptions), errors(rowErrors),
+		allLanes(rowErrors != nullptr ? BATCH_BLOCK : 0, 1), base(0), n(0) {}
+	void evaluate(size_t rows, T* result) {
+		for (base = 0; base < rows; base += BATCH_BLOCK) {
+			n = std::min(BATCH_BLOCK, rows - base);
+			stack.clear();
+			run(0, program.code.size(), nullptr, 0);
+			const T* top = stack.pop();
+			std::copy(top, top + n, result + base);
+			if (errors != nullptr && (options->nanIsError || options->infinityIsError)) {
+				unsigned char reported = static_cast<unsigned char>((options->nanIsError ? BATCH_NOT_A_NUMBER : 0) |
+					(options->infinityIsError ? BATCH_INFINITY : 0));
+				unsigned char* flags = errors + base;
+				const size_t count = n;
+				for (size_t i = 0; i < count; i++) flags[i] |= nonFiniteFlags<T>(top[i]) & reported;
+			}
+		}
+	}
+};
+template<typename T>
+void evaluateProgramBatch(const CompiledExpression& program, const std::vector<const T*>& sources,
+	const std::vector<T>& scalars, const std::vector<const TNativeFunction*>& natives, size_t rows, T* result,
+	const TBatchOptions* options = nullptr, unsigned char* errors = nullptr,
+	std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+	TBatchRunner<T> runner(program, sources, scalars, natives, options, errors, resource);
+	runner.evaluate(rows, result);
+}
+//    :     status,
+//     BatchError   
+template<typename T>
+TBatchReport evaluateProgramBatchReport(const CompiledExpression& program, const std::map<std::string, const T*>& columns,
+	const std::map<std::string, T>& variables, const TFunctionTable& functions, size_t rows, T* result,
+	const TBatchOptions& options, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+	TBatchReport report;
+	std::vector<const T*> sources;
+	std::vector<T> scalars;
+	std::vector<const TNativeFunction*> natives;
+	if (!tryBindColumns<T>(program, columns, variables, sources, scalars, report.message)) {
+		report.status = BatchStatus::UndefinedVariable;
+		return report;
+	}
+	if (!tryBindFunctions(program, functions, natives, report.message)) {
+		report.status = BatchStatus::UnknownFunction;
+		return report;
+	}
+	report.rowErrors.assign(rows, 0);
+	evaluateProgramBatch<T>(program, sources, scalars, natives, rows, result, &options, report.rowErrors.data(), resource);
+	countBatchErrors(report);
+	return report;
+}
+template<typename T>
+class TPostfixT {
+private:
+	CompiledExpression program;
+	std::map<std::string, T> variables;
+	TFunctionTable functions;
+public:
+	explicit TPostfixT(const CompiledExpression& compiled, const TFunctionTable& table = TFunctionTable())
+		: program(compiled), functions(table) {}
+	explicit TPostfixT(const std::string& infixExpr, const TFunctionTable& table = TFunctionTable()) : functions(table) {
+		TPostfix parser(infixExpr);
+		parser.setFunctions(functions);
+		program = parser.compile();
+	}
+	const CompiledExpression& GetProgram() const {
+		return program;
+	}
+	void SetVariable(const std::string& name, T value) {
+		variables[name] = value;
+	}
+	T GetVariable(const std::string& name) const {
+		auto it = variables.find(name);
+		if (it != variables.end()) {
+			return it->second;
+		}
+		throw std::invalid_argument("Variable '" + name + "' not found");
+	}
+	T calculate() const {
+		return evaluateProgram<T>(program, bindVariables<T>(program, variables), bindFunctions(program, functions));
+	}
+	void calculateBatch(const std::map<std::string, const T*>& columns, size_t rows, T* result) const {
+		std::vector<const T*> sources;
+		std::vector<T> scalars;
+		bindColumns<T>(program, columns, variables, sources, scalars);
+		evaluateProgramBatch<T>(program, sources, scalars, bindFunctions(program, functions), rows, result);
+	}
+	TBatchReport calculateBatch(const std::map<std::string, const T*>& columns, size_t rows, T* result,
+		const TBatchOptions& options) const {
+		return evaluateProgramBatchReport<T>(program, columns, variables, functions, rows, result, options);
+	}
+};
@@ -0,0 +1,48 @@
+//  :    ( std::expected  C++17)
+#pragma once
+#include <utility>
+#include <variant>
+template<typename E>
+struct TUnexpected {
+	E error;
+};
+template<typename E>
+TUnexpected<E> makeUnexpected(E error) {
+	return TUnexpected<E>{ std::move(error) };
+}
+template<typename T, typename E>
+class TExpected {
+private:
+	std::variant<T, E> storage;
+public:
+	TExpected(const T& value) : storage(std::in_place_index<0>, value) {}
+	TExpected(T&& value) : storage(std::in_place_index<0>, std::move(value)) {}
+	TExpected(TUnexpected<E> unexpected) : storage(std::in_place_index<1>, std::move(unexpected.error)) {}
+	bool hasValue() const {
+		return storage.index() == 0;
+	}
+	explicit operator bool() const {
+		return hasValue();
+	}
+	T& value() {
+		return std::get<0>(storage);
+	}
+	const T& value() const {
+		return std::get<0>(storage);
+	}
+	const E& error() const {
+		return std::get<1>(storage);
+	}
+	T& operator*() {
+		return value();
+	}
+	const T& operator*() const {
+		return value();
+	}
+	T* operator->() {
+		return &value();
+	}
+	const T* operator->() const {
+		return &value();
+	}
+};
@@ -0,0 +1,39 @@
+//   ()   
+//
+//          :
+//   FUNCTION_PURE              -     
+//   FUNCTION_VECTORIZABLE      -   ,       
+//   FUNCTION_CONSTANT_FOLDABLE -       
+//                                (    FUNCTION_PURE)
+//        ( n   )
+//   n   out; out    .
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+enum FunctionFlags : unsigned {
+	FUNCTION_PURE = 1,
+	FUNCTION_VECTORIZABLE = 2,
+	FUNCTION_CONSTANT_FOLDABLE = 4
+};
+typedef std::function<double(const double* args)> ScalarFunction;
+typedef std::function<void(const double* const* args, size_t n, double* out)> BlockFunction;
+struct TNativeFunction {
+	std::string name;
+	int arity;
+	unsigned flags;
+	ScalarFunction scalar;
+	BlockFunction block;
+};
+bool isBuiltinFunction(const std::string& name);
+class TFunctionTable {
+private:
+	std::vector<TNativeFunction> functions;
+public:
+	void add(const std::string& name, int arity, ScalarFunction scalar, unsigned flags = FUNCTION_PURE);
+	void add(const std::string& name, int arity, ScalarFunction scalar, BlockFunction block,
+		unsigned flags = FUNCTION_PURE | FUNCTION_VECTORIZABLE);
+	const TNativeFunction* find(const std::string& name) const;
+	size_t GetCount() const;
+};
@@ -0,0 +1,26 @@
+//     
+//
+//   (  little-endian):
+//   0   char[4]   "TPLB"
+//   4   uint32    
+//   8   uint32    
+//   12  uint32     FNV-1a   
+//   16   :
+//       uint32  , uint32  , uint32  ,
+//       uint32   (   2)
+//       : uint8  , int32 
+//       : double
+//       : uint32 ,  
+//       : uint32  , uint32 ,  
+#pragma once
+#include "arithmetic.h"
+#include <cstddef>
+#include <cstdint>
+class TFormulaLibrary {
+public:
+	static const uint32_t VERSION = 2;
+	static std::vector<unsigned char> serialize(const std::vector<CompiledExpression>& programs);
+	static std::vector<CompiledExpression> deserialize(const unsigned char* data, size_t size);
+	static void save(const std::string& path, const std::vector<CompiledExpression>& programs);
+	static std::vector<CompiledExpression> load(const std::string& path);
+};
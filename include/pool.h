@@ -0,0 +1,66 @@
+//     
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+//     :     ,    ;
+// ,   ,    
+class TTaskPool {
+private:
+	struct TQueue {
+		std::mutex mutex;
+		std::deque<std::function<void()>> tasks;
+	};
+	std::vector<std::unique_ptr<TQueue>> queues;
+	std::vector<std::thread> workers;
+	std::mutex sleepMutex;
+	std::condition_variable wakeup;
+	std::atomic<size_t> queued;
+	std::atomic<size_t> next;
+	bool stopping;
+	size_t currentQueue() const;
+	bool take(size_t index, std::function<void()>& task);
+	void work(size_t index);
+public:
+	explicit TTaskPool(size_t threads);
+	TTaskPool(const TTaskPool&) = delete;
+	TTaskPool& operator=(const TTaskPool&) = delete;
+	~TTaskPool();
+	size_t GetThreadCount() const;
+	void submit(std::function<void()> task);
+	bool runPending();
+};
+class TTaskGroup {
+private:
+	TTaskPool& pool;
+	std::atomic<size_t> remaining;
+	std::mutex mutex;
+	std::exception_ptr failure;
+	void finish();
+public:
+	explicit TTaskGroup(TTaskPool& taskPool);
+	TTaskGroup(const TTaskGroup&) = delete;
+	TTaskGroup& operator=(const TTaskGroup&) = delete;
+	~TTaskGroup();
+	void spawn(std::function<void()> task);
+	void wait();
+};
+//  body(k)  k  [0, count), body(0) -   
+template<typename F>
+void parallelFor(TTaskPool& pool, size_t count, const F& body) {
+	TTaskGroup group(pool);
+	for (size_t k = 1; k < count; k++) {
+		group.spawn([&body, k] {
+			body(k);
+		});
+	}
+	body(0);
+	group.wait();
+}
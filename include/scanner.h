@@ -0,0 +1,21 @@
+//      
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#if defined(__AVX2__)
+const size_t SCANNER_BLOCK = 32;
+#else
+const size_t SCANNER_BLOCK = 16;
+#endif
+struct TCharClasses {
+	uint32_t space;
+	uint32_t digit;
+	uint32_t identifier;
+	uint32_t op;
+	uint32_t bracket;
+	uint32_t separator;
+	uint32_t delimiter() const;
+};
+TCharClasses classifyChars(const char* p, size_t n);
+const char* skipSpaces(const char* p, const char* end);
+const char* findDelimiter(const char* p, const char* end);
@@ -7,66 +7,234 @@
 // -     
 // -  
 //        
+// push_unchecked  pop_unchecked      ( assert   ),
+//    ,     
+//       Growth,    Allocator;
+//    ,   shrink_to_fit
+//    ,      propagate_on_container_*,
+// TPmrStack     std::pmr::memory_resource
+#pragma once
 #include <iostream>
 #include <algorithm>
+#include <cassert>
+#include <memory>
+#include <memory_resource>
 #include <stdexcept>
-template<typename T>
+#include <type_traits>
+#include <utility>
+//  : grow(capacity, required)      required
+template<int Numerator = 2, int Denominator = 1>
+struct TGeometricGrowth {
+	static_assert(Denominator > 0 && Numerator > Denominator, "Growth factor must be greater than one");
+	static int grow(int capacity, int required) {
+		return std::max(required, static_cast<int>(static_cast<long long>(capacity) * Numerator / Denominator));
+	}
+};
+template<int Increment>
+struct TFixedGrowth {
+	static_assert(Increment > 0, "Growth increment must be positive");
+	static int grow(int capacity, int required) {
+		return std::max(required, capacity + Increment);
+	}
+};
+template<typename T, typename Growth = TGeometricGrowth<>, typename Allocator = std::allocator<T>>
 class TStack {
 private:
+	typedef std::allocator_traits<Allocator> TTraits;
+	Allocator allocator;
 	T* data;
 	int capacity;
 	int topIndex;
+	void reallocate(int newCapacity) {
+		T* newData = TTraits::allocate(allocator, newCapacity);
+		int built = 0;
+		try {
+			for (; built <= topIndex; built++) {
+				TTraits::construct(allocator, newData + built, std::move_if_noexcept(data[built]));
+			}
+		}
+		catch (...) {
+			destroy(newData, built);
+			TTraits::deallocate(allocator, newData, newCapacity);
+			throw;
+		}
+		release();
+		data = newData;
+		capacity = newCapacity;
+	}
+	void destroy(T* items, int count) {
+		for (int i = 0; i < count; i++) {
+			TTraits::destroy(allocator, items + i);
+		}
+	}
+	void release() {
+		if (data != nullptr) {
+			destroy(data, topIndex + 1);
+			TTraits::deallocate(allocator, data, capacity);
+			data = nullptr;
+		}
+	}
+	T take() {
+		T value = std::move(data[topIndex]);
+		TTraits::destroy(allocator, data + topIndex);
+		topIndex--;
+		return value;
+	}
+	void steal(TStack& other) {
+		data = other.data;
+		capacity = other.capacity;
+		topIndex = other.topIndex;
+		other.data = nullptr;
+		other.capacity = 0;
+		other.topIndex = -1;
+	}
+	//    -        ,  
+	void moveFrom(TStack& other) {
+		int size = std::max(other.capacity, 1);
+		capacity = 0;
+		topIndex = -1;
+		data = TTraits::allocate(allocator, size);
+		capacity = size;
+		try {
+			for (int i = 0; i <= other.topIndex; i++) {
+				TTraits::construct(allocator, data + i, std::move_if_noexcept(other.data[i]));
+				topIndex = i;
+			}
+		}
+		catch (...) {
+			release();
+			throw;
+		}
+		other.clear();
+	}
+	void copyFrom(const TStack& other) {
+		int size = std::max(other.capacity, 1);
+		capacity = 0;
+		topIndex = -1;
+		data = TTraits::allocate(allocator, size);
+		capacity = size;
+		try {
+			for (int i = 0; i <= other.topIndex; i++) {
+				TTraits::construct(allocator, data + i, other.data[i]);
+				topIndex = i;
+			}
+		}
+		catch (...) {
+			release();
+			throw;
+		}
+	}
 public:
-	TStack(int initialCapacity = 10) : capacity(initialCapacity), topIndex(-1) {
+	TStack(int initialCapacity = 10, const Allocator& alloc = Allocator())
+		: allocator(alloc), data(nullptr), capacity(initialCapacity), topIndex(-1) {
 		if (initialCapacity <= 0) {
 			throw std::invalid_argument("Stack capacity must be positive");
 		}
-		data = new T[capacity];
-		if (data == nullptr) {
-			throw std::bad_alloc();
-		}
+		data = TTraits::allocate(allocator, capacity);
 	}
 	void resize(int newCapacity) {
-		T* newData = new T[newCapacity];
-		for (int i = 0; i <= topIndex; i++) 
-			newData[i] = data[i];
-		delete[] data;
-		data = newData;
-		capacity = newCapacity;
+		if (newCapacity <= 0 || newCapacity < GetSize()) {
+			throw std::invalid_argument("Stack capacity must be positive and not less than its size");
+		}
+		reallocate(newCapacity);
+	}
+	void reserve(int newCapacity) {
+		if (newCapacity > capacity) {
+			reallocate(newCapacity);
+		}
 	}
-	TStack(const TStack& other) : capacity(other.capacity), topIndex(other.topIndex) {
-		data = new T[capacity];
-		for (int i = 0; i <= topIndex; i++) {
-			data[i] = other.data[i];
+	void shrink_to_fit() {
+		int fitted = std::max(GetSize(), 1);
+		if (fitted < capacity) {
+			reallocate(fitted);
+		}
+	}
+	TStack(const TStack& other)
+		: allocator(TTraits::select_on_container_copy_construction(other.allocator)), data(nullptr), capacity(0), topIndex(-1) {
+		copyFrom(other);
+	}
+	TStack(const TStack& other, const Allocator& alloc) : allocator(alloc), data(nullptr), capacity(0), topIndex(-1) {
+		copyFrom(other);
+	}
+	TStack(TStack&& other) noexcept : allocator(std::move(other.allocator)), data(nullptr), capacity(0), topIndex(-1) {
+		steal(other);
+	}
+	TStack(TStack&& other, const Allocator& alloc) : allocator(alloc), data(nullptr), capacity(0), topIndex(-1) {
+		if (allocator == other.allocator) {
+			steal(other);
+		}
+		else {
+			moveFrom(other);
 		}
 	}
 	TStack& operator=(const TStack& other) {
 		if (this != &other) {
-			delete[] data;
-			capacity = other.capacity;
-			topIndex = other.topIndex;
-			data = new T[capacity];
-			for (int i = 0; i <= topIndex; i++) {
-				data[i] = other.data[i];
+			release();
+			if constexpr (TTraits::propagate_on_container_copy_assignment::value) {
+				allocator = other.allocator;
+			}
+			copyFrom(other);
+		}
+		return *this;
+	}
+	TStack& operator=(TStack&& other) noexcept(TTraits::propagate_on_container_move_assignment::value || TTraits::is_always_equal::value) {
+		if (this == &other) {
+			return *this;
+		}
+		release();
+		if constexpr (TTraits::propagate_on_container_move_assignment::value) {
+			allocator = std::move(other.allocator);
+			steal(other);
+		}
+		else {
+			if (allocator == other.allocator) {
+				steal(other);
+			}
+			else {
+				moveFrom(other);
 			}
 		}
 		return *this;
 	}
+	void swap(TStack& other) noexcept {
+		using std::swap;
+		if constexpr (TTraits::propagate_on_container_swap::value) {
+			swap(allocator, other.allocator);
+		}
+		else {
+			assert(allocator == other.allocator);
+		}
+		swap(data, other.data);
+		swap(capacity, other.capacity);
+		swap(topIndex, other.topIndex);
+	}
+	Allocator get_allocator() const {
+		return allocator;
+	}
 	~TStack() {
-		delete[] data;
-		data = nullptr;
+		release();
 	}
 	void push(const T& value) {
 		if (isFull()) {
-			resize(capacity * 2);
+			reallocate(Growth::grow(capacity, capacity + 1));
 		}
-		data[++topIndex] = value;
+		TTraits::construct(allocator, data + topIndex + 1, value);
+		topIndex++;
 	}
 	T pop() {
 		if (isEmpty()) {
 			throw std::underflow_error("Cannot pop from empty stack");
 		}
-		return data[topIndex--];
+		return take();
+	}
+	void push_unchecked(const T& value) {
+		assert(!isFull());
+		TTraits::construct(allocator, data + topIndex + 1, value);
+		topIndex++;
+	}
+	T pop_unchecked() {
+		assert(!isEmpty());
+		return take();
 	}
 	T peek() const {
 		if (isEmpty()) {
@@ -87,6 +255,7 @@ public:
 		return capacity;
 	}
 	void clear() {
+		destroy(data, topIndex + 1);
 		topIndex = -1;
 	}
 	void print() {
@@ -104,4 +273,10 @@ public:
 		}
 		std::cout << std::endl;
 	}
-};
\ No newline at end of file
+};
+template<typename T, typename Growth, typename Allocator>
+void swap(TStack<T, Growth, Allocator>& a, TStack<T, Growth, Allocator>& b) noexcept {
+	a.swap(b);
+}
+template<typename T, typename Growth = TGeometricGrowth<>>
+using TPmrStack = TStack<T, Growth, std::pmr::polymorphic_allocator<T>>;
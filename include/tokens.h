@@ -0,0 +1,36 @@
+//      
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+enum TokenKind : unsigned char {
+	TOKEN_NUMBER,
+	TOKEN_VARIABLE,
+	TOKEN_FUNCTION,
+	TOKEN_OPERATOR,
+	TOKEN_OPEN,
+	TOKEN_CLOSE,
+	TOKEN_SEPARATOR
+};
+const unsigned char TOKEN_UNKNOWN_OPERATOR = 0xFF;
+// operators -   (  -   ), precedences - ,
+// offsets/lengths -    , values -    
+//     , constants -    
+struct TokenBuffer {
+	std::vector<unsigned char> kinds;
+	std::vector<unsigned char> operators;
+	std::vector<unsigned char> precedences;
+	std::vector<uint32_t> offsets;
+	std::vector<uint32_t> lengths;
+	std::vector<uint32_t> values;
+	std::vector<double> constants;
+	size_t size() const;
+	bool empty() const;
+	void clear();
+	void reserve(size_t count);
+	void push(TokenKind kind, unsigned char op, unsigned char precedence, size_t offset, size_t length);
+	void pushNumber(double value, size_t offset, size_t length);
+	void pop();
+	void replace(size_t first, size_t last, const TokenBuffer& window);
+	void shift(size_t first, long long delta);
+};
@@ -0,0 +1,16 @@
+//  ()     double
+//
+//   std::   :
+//   expBlock, logBlock -   1 ulp
+//   sinBlock, cosBlock -   2 ulp  |x| <= VECMATH_TRIG_LIMIT,
+//                              std::sin/std::cos
+//   sqrtBlock, absBlock - 
+#pragma once
+#include <cstddef>
+const double VECMATH_TRIG_LIMIT = 1e5;
+void expBlock(const double* x, size_t n, double* out);
+void logBlock(const double* x, size_t n, double* out);
+void sinBlock(const double* x, size_t n, double* out);
+void cosBlock(const double* x, size_t n, double* out);
+void sqrtBlock(const double* x, size_t n, double* out);
+void absBlock(const double* x, size_t n, double* out);
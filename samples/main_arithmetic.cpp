@@ -1,10 +1,41 @@
 // реализация пользовательского приложения
 #include "arithmetic.h"
+#include "columns.h"
 #include <iostream>
-int main()
+int main(int argc, char** argv)
 {
+	if (argc == 4) {
+		try {
+			TPostfix postfix(argv[1]);
+			TColumnFile input(argv[2]);
+			std::map<std::string, const double*> columns;
+			for (size_t i = 0; i < input.GetColumnCount(); i++) {
+				columns[input.GetName(i)] = input.GetColumn(i);
+			}
+			std::vector<double> result(input.GetRowCount());
+			TBatchOptions options;
+			options.nanIsError = true;
+			options.infinityIsError = true;
+			TBatchReport report = postfix.calculateBatch(columns, result.size(), result.data(), options);
+			if (report.status != BatchStatus::Ok) {
+				std::cout << "ERROR: " << report.message << std::endl;
+				return 1;
+			}
+			TColumnFile::write(argv[3], { "result" }, { result.data() }, result.size());
+			std::cout << "ROWS EVALUATED: " << result.size() << std::endl;
+			std::cout << "ROWS FAILED: " << report.failedRows << " (division by zero: " << report.divisionByZero
+				<< ", NaN: " << report.notANumber << ", infinity: " << report.infinity << ")" << std::endl;
+		}
+		catch (const std::exception& e) {
+			std::cout << "ERROR: " << e.what() << std::endl;
+			return 1;
+		}
+		return 0;
+	}
 	std::cout << "===== SIMPLE EXPRESSION CALCULATOR =====" << std::endl;
 	std::cout << "Operations are supported: +, -, *, /, ^" << std::endl;
+	std::cout << "Conditions are supported: <, <=, >, >=, ==, !=, &&, ||, !, ?:" << std::endl;
+	std::cout << "Functions are supported: sin, cos, exp, log, sqrt, abs, min, max" << std::endl;
 	std::cout << "The use of variables and brackets is supported" << std::endl;
 	std::cout << "Examples: 2+3*4, (a+b)*c, x^2+y^2" << std::endl << std::endl;
 	while (true) {
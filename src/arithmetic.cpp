@@ -1,24 +1,358 @@
 //        
 #include "stack.h"
 #include "arithmetic.h"
-#include <sstream>
+#include "columns.h"
+#include "evaluator.h"
+#include "scanner.h"
 #include <cmath>
 #include <cctype>
+#include <charconv>
 #include <algorithm>
+#include <exception>
 #include <iostream>
 #include <stdexcept>
-Token::Token(const std::string& val, const std::string& typ) : value(val), type(typ) {}
-void TPostfix::initializePriority() {
-	priority['+'] = 1;
-	priority['-'] = 1;
-	priority['*'] = 2;
-	priority['/'] = 2;
-	priority['^'] = 3;
-	priority['('] = 0;
-	priority[')'] = 0;
+#include <thread>
+Token::Token(const std::string& val, const std::string& typ, double num, size_t off) : value(val), type(typ), number(num), arity(0), offset(off) {}
+namespace {
+//       PARALLEL_LEX_MIN ,    PARALLEL_LEX_CHUNK
+const size_t PARALLEL_LEX_MIN = 1 << 18;
+const size_t PARALLEL_LEX_CHUNK = 1 << 16;
+//   -     PARALLEL_CHECK_CHUNK 
+const size_t PARALLEL_CHECK_CHUNK = 1 << 15;
+//         ( '!'  '?'   ),
+//           
+const int ORDER_STACK_CAPACITY = 16;
+struct TBuiltinFunction {
+	const char* name;
+	OpCode op;
+	int arity;
+};
+const TBuiltinFunction BUILTIN_FUNCTIONS[] = {
+	{ "sin", OpCode::Sin, 1 },
+	{ "cos", OpCode::Cos, 1 },
+	{ "exp", OpCode::Exp, 1 },
+	{ "log", OpCode::Log, 1 },
+	{ "sqrt", OpCode::Sqrt, 1 },
+	{ "abs", OpCode::Abs, 1 },
+	{ "min", OpCode::Min, -1 },
+	{ "max", OpCode::Max, -1 }
+};
+struct TOperator {
+	const char* name;
+	OpCode op;
+	unsigned char priority;
+};
+const TOperator OPERATORS[] = {
+	{ "+", OpCode::Add, 6 },
+	{ "-", OpCode::Sub, 6 },
+	{ "*", OpCode::Mul, 7 },
+	{ "/", OpCode::Div, 7 },
+	{ "^", OpCode::Pow, 8 },
+	{ "<=", OpCode::LessEqual, 5 },
+	{ ">=", OpCode::GreaterEqual, 5 },
+	{ "==", OpCode::Equal, 4 },
+	{ "!=", OpCode::NotEqual, 4 },
+	{ "&&", OpCode::And, 3 },
+	{ "||", OpCode::Or, 2 },
+	{ "<", OpCode::Less, 5 },
+	{ ">", OpCode::Greater, 5 },
+	{ "!", OpCode::Not, 9 },
+	{ "?", OpCode::Select, 1 },
+	{ ":", OpCode::Select, 1 }
+};
+const TOperator* matchOperator(const char* p, const char* end) {
+	for (const TOperator& op : OPERATORS) {
+		size_t length = std::char_traits<char>::length(op.name);
+		if (static_cast<size_t>(end - p) >= length && std::equal(op.name, op.name + length, p)) {
+			return &op;
+		}
+	}
+	return nullptr;
+}
+unsigned char operatorIndex(const char* name) {
+	return static_cast<unsigned char>(matchOperator(name, name + std::char_traits<char>::length(name)) - OPERATORS);
+}
+const unsigned char OPERATOR_MINUS = operatorIndex("-");
+const unsigned char OPERATOR_NOT = operatorIndex("!");
+const unsigned char OPERATOR_QUESTION = operatorIndex("?");
+const unsigned char OPERATOR_COLON = operatorIndex(":");
+//      
+enum TAdjacency {
+	ADJACENT_OK,
+	ADJACENT_TWO_OPERATORS,
+	ADJACENT_NOT_AFTER_OPERAND,
+	ADJACENT_TWO_OPERANDS,
+	ADJACENT_BRACKET_AFTER_OPERAND,
+	ADJACENT_CLOSE_AFTER_OPERATOR,
+	ADJACENT_FUNCTION_WITHOUT_BRACKET,
+	ADJACENT_FUNCTION_AFTER_OPERAND,
+	ADJACENT_SEPARATOR_WITHOUT_OPERAND,
+	ADJACENT_NOTHING_AFTER_SEPARATOR
+};
+bool isPrefixOperator(unsigned char kind, unsigned char op) {
+	return kind == TOKEN_OPERATOR && (op == OPERATOR_MINUS || op == OPERATOR_NOT);
+}
+TAdjacency checkAdjacent(unsigned char previous, unsigned char kind, unsigned char op) {
+	bool lastOperand = previous == TOKEN_NUMBER || previous == TOKEN_VARIABLE;
+	bool operand = kind == TOKEN_NUMBER || kind == TOKEN_VARIABLE;
+	if (previous == TOKEN_OPERATOR && kind == TOKEN_OPERATOR && !isPrefixOperator(kind, op)) {
+		return ADJACENT_TWO_OPERATORS;
+	}
+	if ((lastOperand || previous == TOKEN_CLOSE) && kind == TOKEN_OPERATOR && op == OPERATOR_NOT) {
+		return ADJACENT_NOT_AFTER_OPERAND;
+	}
+	if (lastOperand && operand) {
+		return ADJACENT_TWO_OPERANDS;
+	}
+	if (lastOperand && kind == TOKEN_OPEN) {
+		return ADJACENT_BRACKET_AFTER_OPERAND;
+	}
+	if (previous == TOKEN_OPERATOR && kind == TOKEN_CLOSE) {
+		return ADJACENT_CLOSE_AFTER_OPERATOR;
+	}
+	if (previous == TOKEN_FUNCTION && kind != TOKEN_OPEN) {
+		return ADJACENT_FUNCTION_WITHOUT_BRACKET;
+	}
+	if (lastOperand && kind == TOKEN_FUNCTION) {
+		return ADJACENT_FUNCTION_AFTER_OPERAND;
+	}
+	if ((previous == TOKEN_OPERATOR || previous == TOKEN_OPEN || previous == TOKEN_SEPARATOR) && kind == TOKEN_SEPARATOR) {
+		return ADJACENT_SEPARATOR_WITHOUT_OPERAND;
+	}
+	if (previous == TOKEN_SEPARATOR && (kind == TOKEN_CLOSE || kind == TOKEN_OPERATOR)) {
+		return ADJACENT_NOTHING_AFTER_SEPARATOR;
+	}
+	return ADJACENT_OK;
+}
+//   ;   ,    ,     
+size_t bracketNesting(const unsigned char* kinds, size_t first, size_t last) {
+	size_t depth = 0;
+	size_t deepest = 0;
+	for (size_t i = first; i < last; i++) {
+		if (kinds[i] == TOKEN_OPEN) {
+			deepest = std::max(deepest, ++depth);
+		}
+		else if (kinds[i] == TOKEN_CLOSE && depth > 0) {
+			depth--;
+		}
+	}
+	return deepest;
+}
+const TBuiltinFunction* findBuiltin(const std::string& name) {
+	for (const TBuiltinFunction& function : BUILTIN_FUNCTIONS) {
+		if (name == function.name) {
+			return &function;
+		}
+	}
+	return nullptr;
+}
+//    ,        ','  
+bool isLocalEdit(const TokenBuffer& tokens, size_t first, size_t last) {
+	int depth = 0;
+	for (size_t i = first; i < last; i++) {
+		unsigned char kind = tokens.kinds[i];
+		depth += kind == TOKEN_OPEN ? 1 : kind == TOKEN_CLOSE ? -1 : 0;
+		bool condition = kind == TOKEN_OPERATOR && (tokens.operators[i] == OPERATOR_QUESTION || tokens.operators[i] == OPERATOR_COLON);
+		if (depth < 0 || kind == TOKEN_SEPARATOR || condition) {
+			return false;
+		}
+	}
+	return depth == 0;
+}
+bool foldableCall(const CompiledExpression& program, int arity) {
+	if (program.code.size() < static_cast<size_t>(arity)) {
+		return false;
+	}
+	for (size_t i = program.code.size() - arity; i < program.code.size(); i++) {
+		if (program.code[i].op != OpCode::Number) {
+			return false;
+		}
+	}
+	return true;
+}
+//    +  *      n : 
+//  ,          
+void reassociate(CompiledExpression& program, Reassociation mode, std::pmr::memory_resource* resource) {
+	std::vector<Instruction>& code = program.code;
+	std::vector<int> operands(code.size(), 0);
+	std::vector<bool> merged(code.size(), false);
+	TPmrStack<int> roots(std::max<size_t>(code.size(), 1), resource);
+	for (size_t i = 0; i < code.size(); i++) {
+		if (code[i].op == OpCode::Add || code[i].op == OpCode::Mul) {
+			int operand[2];
+			operand[1] = roots.pop();
+			operand[0] = roots.pop();
+			for (int root : operand) {
+				merged[root] = code[root].op == code[i].op;
+				operands[i] += merged[root] ? operands[root] : 1;
+			}
+		}
+		else {
+			for (int j = operandCount(program, code[i]); j > 0; j--) {
+				roots.pop();
+			}
+		}
+		roots.push(static_cast<int>(i));
+	}
+	size_t size = 0;
+	for (size_t i = 0; i < code.size(); i++) {
+		if (merged[i]) {
+			continue;
+		}
+		code[size] = code[i];
+		if (operands[i] > 2) {
+			code[size].op = code[i].op == OpCode::Mul ? OpCode::Product : mode == Reassociation::Compensated ? OpCode::CompensatedSum : OpCode::Sum;
+			code[size].arg = operands[i];
+		}
+		size++;
+	}
+	code.resize(size);
+}
+//  : c ? a : b -> c JumpIfZero(L1) a Jump(L2) L1: b L2:
+// a && b -> a AndJump(L) b And L:, a || b -> a OrJump(L) b Or L:
+void insertJumps(CompiledExpression& program, std::pmr::memory_resource* resource) {
+	struct TPendingJump {
+		OpCode op;
+		size_t target;
+		int offset;
+	};
+	const std::vector<Instruction>& code = program.code;
+	std::vector<size_t> start(code.size());
+	std::vector<TPendingJump> pending(code.size(), TPendingJump{ OpCode::Number, 0, 0 });
+	TPmrStack<int> roots(std::max<size_t>(code.size(), 1), resource);
+	for (size_t i = 0; i < code.size(); i++) {
+		int operands = operandCount(program, code[i]);
+		int first = static_cast<int>(i);
+		int operand[3] = { 0, 0, 0 };
+		for (int j = operands - 1; j >= 0; j--) {
+			first = roots.pop();
+			if (j < 3) {
+				operand[j] = first;
+			}
+		}
+		start[i] = static_cast<size_t>(first) == i ? i : start[first];
+		if (code[i].op == OpCode::Select) {
+			pending[operand[0]] = TPendingJump{ OpCode::JumpIfZero, start[operand[2]], 0 };
+			pending[operand[1]] = TPendingJump{ OpCode::Jump, i, 0 };
+		}
+		else if (code[i].op == OpCode::And || code[i].op == OpCode::Or) {
+			pending[operand[0]] = TPendingJump{ code[i].op == OpCode::And ? OpCode::AndJump : OpCode::OrJump, i, 1 };
+		}
+		roots.push(static_cast<int>(i));
+	}
+	std::vector<size_t> position(code.size());
+	std::vector<Instruction> result;
+	std::vector<size_t> jumps;
+	result.reserve(code.size() * 2);
+	for (size_t i = 0; i < code.size(); i++) {
+		position[i] = result.size();
+		if (code[i].op != OpCode::Select) {
+			result.push_back(code[i]);
+		}
+		if (pending[i].op != OpCode::Number) {
+			jumps.push_back(i);
+			Instruction jump = { pending[i].op, 0 };
+			result.push_back(jump);
+		}
+	}
+	for (size_t i : jumps) {
+		size_t at = position[i] + (code[i].op != OpCode::Select ? 1 : 0);
+		result[at].arg = static_cast<int>(position[pending[i].target] + pending[i].offset);
+	}
+	program.code.swap(result);
+}
+}
+bool isBuiltinFunction(const std::string& name) {
+	return findBuiltin(name) != nullptr;
+}
+int operandCount(OpCode op) {
+	switch (op) {
+	case OpCode::Number:
+	case OpCode::Variable:
+		return 0;
+	case OpCode::PowInt:
+	case OpCode::Not:
+	case OpCode::Sin:
+	case OpCode::Cos:
+	case OpCode::Exp:
+	case OpCode::Log:
+	case OpCode::Sqrt:
+	case OpCode::Abs:
+		return 1;
+	case OpCode::Add:
+	case OpCode::Sub:
+	case OpCode::Mul:
+	case OpCode::Div:
+	case OpCode::Pow:
+	case OpCode::Min:
+	case OpCode::Max:
+	case OpCode::Less:
+	case OpCode::LessEqual:
+	case OpCode::Greater:
+	case OpCode::GreaterEqual:
+	case OpCode::Equal:
+	case OpCode::NotEqual:
+	case OpCode::And:
+	case OpCode::Or:
+		return 2;
+	case OpCode::Select:
+		return 3;
+	case OpCode::Call:
+	case OpCode::Sum:
+	case OpCode::Product:
+	case OpCode::CompensatedSum:
+		break;
+	}
+	return -1;
+}
+int operandCount(const CompiledExpression& program, const Instruction& instruction) {
+	if (instruction.op == OpCode::Call) {
+		if (instruction.arg < 0 || static_cast<size_t>(instruction.arg) >= program.functions.size()) {
+			return -1;
+		}
+		return program.functions[instruction.arg].arity;
+	}
+	if (instruction.op == OpCode::Sum || instruction.op == OpCode::Product || instruction.op == OpCode::CompensatedSum) {
+		return instruction.arg >= 2 ? instruction.arg : -1;
+	}
+	return operandCount(instruction.op);
+}
+//    ,             ;
+//       -  
+size_t maxStackDepth(const CompiledExpression& program) {
+	const std::vector<Instruction>& code = program.code;
+	std::vector<int> depthAt(code.size() + 1, -1);
+	int depth = 0;
+	int deepest = 0;
+	for (size_t pc = 0; pc < code.size(); pc++) {
+		if (depthAt[pc] >= 0) {
+			depth = depthAt[pc];
+		}
+		const Instruction& instruction = code[pc];
+		if (instruction.op == OpCode::Jump || instruction.op == OpCode::JumpIfZero || instruction.op == OpCode::AndJump || instruction.op == OpCode::OrJump) {
+			if (instruction.arg <= static_cast<int>(pc) || static_cast<size_t>(instruction.arg) > code.size()) {
+				return std::max<size_t>(code.size(), 1);
+			}
+			depth -= instruction.op == OpCode::JumpIfZero ? 1 : 0;
+			depthAt[instruction.arg] = depth;
+			continue;
+		}
+		int operands = operandCount(program, instruction);
+		if (operands < 0) {
+			return std::max<size_t>(code.size(), 1);
+		}
+		depth += 1 - operands;
+		deepest = std::max(deepest, depth);
+	}
+	return static_cast<size_t>(std::max(deepest, 1));
 }
 bool TPostfix::isOperator(char c) const {
-	return c == '+' || c == '-' || c == '*' || c == '/' || c == '^';
+	switch (c) {
+	case '+': case '-': case '*': case '/': case '^':
+	case '<': case '>': case '=': case '!': case '&': case '|': case '?': case ':':
+		return true;
+	}
+	return false;
 }
 bool TPostfix::isBracket(char c) const {
 	return c == '(' || c == ')';
@@ -26,35 +360,89 @@ bool TPostfix::isBracket(char c) const {
 bool TPostfix::isVariableChar(char c) const {
 	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
 }
+bool TPostfix::isDelimiter(char c) const {
+	return std::isspace(static_cast<unsigned char>(c)) || isOperator(c) || isBracket(c) || c == ',';
+}
 bool TPostfix::isNumber(const std::string& str) const {
-	if (str.empty()) return false;
-	size_t start = 0;
-	if (str[0] == '-' && str.length() > 1) {
-		start = 1;
+	double value;
+	const char* last = str.data() + str.size();
+	return !str.empty() && scanNumber(str.data(), last, value) == last;
+}
+const char* TPostfix::scanNumber(const char* first, const char* last, double& value) const {
+	const char* p = first;
+	if (p != last && *p == '-') {
+		p++;
 	}
-	bool hasDecimal = false;
-	bool hasDigit = false;
-	for (size_t i = start; i < str.length(); i++) {
-		if (str[i] == '.') {
-			if (hasDecimal) return false;
-			hasDecimal = true;
-		}
-		else if (std::isdigit(str[i])) {
-			hasDigit = true;
-		}
-		else {
-			return false;
-		}
+	if (p == last || !(std::isdigit(static_cast<unsigned char>(*p)) || *p == '.')) {
+		return first;
+	}
+	std::from_chars_result result = std::from_chars(first, last, value);
+	if (result.ec != std::errc()) {
+		return first;
 	}
-	return hasDigit;
+	return result.ptr;
 }
-TPostfix::TPostfix(const std::string& infixExpr) : infix(infixExpr) {
-	initializePriority();
+bool TPostfix::isFunction(const std::string& name) const {
+	return findBuiltin(name) != nullptr || functions.find(name) != nullptr;
 }
+int TPostfix::functionArity(const std::string& name) const {
+	const TBuiltinFunction* builtin = findBuiltin(name);
+	return builtin != nullptr ? builtin->arity : functions.find(name)->arity;
+}
+TPostfix::TPostfix(const std::string& infixExpr) : infix(infixExpr), threads(1), reassociation(Reassociation::Strict),
+	resource(std::pmr::get_default_resource()) {}
 void TPostfix::setInfix(const std::string& infixExpr) {
 	infix = infixExpr;
 	postfix = "";
+	postfixOrder.clear();
 	tokens.clear();
+	program = CompiledExpression();
+}
+void TPostfix::setProgram(const CompiledExpression& compiled) {
+	setInfix("");
+	program = compiled;
+}
+void TPostfix::registerFunction(const std::string& name, int arity, ScalarFunction scalar, unsigned flags) {
+	functions.add(name, arity, scalar, flags);
+	if (!infix.empty()) {
+		setInfix(infix);
+	}
+}
+void TPostfix::registerFunction(const std::string& name, int arity, ScalarFunction scalar, BlockFunction block, unsigned flags) {
+	functions.add(name, arity, scalar, block, flags);
+	if (!infix.empty()) {
+		setInfix(infix);
+	}
+}
+void TPostfix::setFunctions(const TFunctionTable& table) {
+	functions = table;
+	if (!infix.empty()) {
+		setInfix(infix);
+	}
+}
+const TFunctionTable& TPostfix::GetFunctions() const {
+	return functions;
+}
+void TPostfix::setThreads(unsigned count) {
+	threads = count;
+}
+unsigned TPostfix::GetThreads() const {
+	return threads;
+}
+void TPostfix::setReassociation(Reassociation mode) {
+	if (mode != reassociation) {
+		reassociation = mode;
+		program = CompiledExpression();
+	}
+}
+Reassociation TPostfix::GetReassociation() const {
+	return reassociation;
+}
+void TPostfix::setMemoryResource(std::pmr::memory_resource* memory) {
+	resource = memory != nullptr ? memory : std::pmr::get_default_resource();
+}
+std::pmr::memory_resource* TPostfix::GetMemoryResource() const {
+	return resource;
 }
 std::string TPostfix::GetInfix() const {
 	std::string result = infix;
@@ -77,186 +465,736 @@ double TPostfix::GetVariable(const std::string& name) const {
 	}
 	throw std::invalid_argument("Variable '" + name + "' not found");
 }
-std::vector<Token> TPostfix::tokenize() {
+std::string TPostfix::tokenText(size_t index) const {
+	return infix.substr(tokens.offsets[index], tokens.lengths[index]);
+}
+//        ( )     p
+const char* TPostfix::lexToken(const char* p, const char* end, TokenKind previous, TokenBuffer& output) const {
+	char c = *p;
+	size_t offset = p - infix.data();
+	bool unary = c == '-' && (previous == TOKEN_OPEN || previous == TOKEN_SEPARATOR || previous == TOKEN_OPERATOR);
+	if (!unary && isOperator(c)) {
+		const TOperator* op = matchOperator(p, end);
+		if (op == nullptr) {
+			output.push(TOKEN_OPERATOR, TOKEN_UNKNOWN_OPERATOR, 0, offset, 1);
+			return p + 1;
+		}
+		size_t length = std::char_traits<char>::length(op->name);
+		output.push(TOKEN_OPERATOR, static_cast<unsigned char>(op - OPERATORS), op->priority, offset, length);
+		return p + length;
+	}
+	if (isBracket(c) || c == ',') {
+		output.push(c == '(' ? TOKEN_OPEN : c == ')' ? TOKEN_CLOSE : TOKEN_SEPARATOR, 0, 0, offset, 1);
+		return p + 1;
+	}
+	double value;
+	const char* numberEnd = scanNumber(p, end, value);
+	if (numberEnd != p && (numberEnd == end || isDelimiter(*numberEnd))) {
+		output.pushNumber(value, offset, numberEnd - p);
+		return numberEnd;
+	}
+	const char* wordEnd = findDelimiter(p + 1, end);
+	const char* next = skipSpaces(wordEnd, end);
+	std::string word(p, wordEnd);
+	if (next < end && *next == '(' && isFunction(word)) {
+		output.push(TOKEN_FUNCTION, 0, 0, offset, word.size());
+	}
+	else {
+		bool invalid = !std::all_of(word.begin(), word.end(), [this](char w) {
+			return isVariableChar(w);
+		});
+		output.push(TOKEN_VARIABLE, invalid ? 1 : 0, 0, offset, word.size());
+	}
+	return wordEnd;
+}
+size_t TPostfix::threadCount() const {
+	return threads != 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+}
+//     ,      
+TTaskPool& TPostfix::taskPool() {
+	if (!pool || pool->GetThreadCount() + 1 != threadCount()) {
+		pool = std::make_shared<TTaskPool>(threadCount() - 1);
+	}
+	return *pool;
+}
+void TPostfix::lex() {
+	if (threadCount() > 1 && infix.size() >= PARALLEL_LEX_MIN) {
+		lexParallel(std::min(threadCount(), infix.size() / PARALLEL_LEX_CHUNK));
+		return;
+	}
 	tokens.clear();
-	std::string currentToken = "";
-	for (size_t i = 0; i < infix.length(); i++) {
-		char c = infix[i];
-		if (std::isspace(c)) {
-			if (!currentToken.empty()) {
-				std::string type = isNumber(currentToken) ? "number" : "variable";
-				tokens.push_back(Token(currentToken, type));
-				currentToken = "";
+	tokens.reserve(infix.size() / 2 + 1);
+	const char* end = infix.data() + infix.size();
+	const char* p = skipSpaces(infix.data(), end);
+	while (p < end) {
+		TokenKind previous = tokens.empty() ? TOKEN_OPEN : static_cast<TokenKind>(tokens.kinds.back());
+		p = skipSpaces(lexToken(p, end, previous, tokens), end);
+	}
+}
+//         ,    '-':
+//   -  ,   ,   
+//     ,    
+void TPostfix::lexParallel(size_t count) {
+	const char* begin = infix.data();
+	const char* end = begin + infix.size();
+	std::vector<const char*> bounds(1, begin);
+	for (size_t i = 1; i < count; i++) {
+		const char* p = std::max(begin + infix.size() * i / count, bounds.back());
+		const char* stop = begin + infix.size() * (i + 1) / count;
+		while (p < stop && !isBracket(*p) && *p != ',') {
+			if (std::isspace(static_cast<unsigned char>(*p))) {
+				p = skipSpaces(p, end);
+				if (p < end && *p != '-') {
+					break;
+				}
 			}
-			continue;
-		}
-		if (c == '-' && (tokens.empty() || tokens.back().value == "(" || tokens.back().type == "operator")) {
-			currentToken += c;
-			continue;
-		}
-		if (isOperator(c) || isBracket(c)) {
-			if (!currentToken.empty()) {
-				std::string type = isNumber(currentToken) ? "number" : "variable";
-				tokens.push_back(Token(currentToken, type));
-				currentToken = "";
+			else {
+				p++;
 			}
-			std::string type = isBracket(c) ? "bracket" : "operator";
-			tokens.push_back(Token(std::string(1, c), type));
 		}
-		else {
-			currentToken += c;
+		if (p < stop && p > bounds.back()) {
+			bounds.push_back(p);
+		}
+	}
+	bounds.push_back(end);
+	std::vector<TokenBuffer> parts(bounds.size() - 1);
+	parallelFor(taskPool(), parts.size(), [this, &parts, &bounds, end](size_t k) {
+		TokenBuffer& part = parts[k];
+		part.reserve((bounds[k + 1] - bounds[k]) / 2 + 1);
+		const char* p = skipSpaces(bounds[k], end);
+		while (p < bounds[k + 1]) {
+			TokenKind previous = part.empty() ? TOKEN_OPEN : static_cast<TokenKind>(part.kinds.back());
+			p = skipSpaces(lexToken(p, end, previous, part), end);
 		}
+	});
+	tokens.clear();
+	size_t total = 0;
+	for (const TokenBuffer& part : parts) {
+		total += part.size();
 	}
-	if (!currentToken.empty()) {
-		std::string type = isNumber(currentToken) ? "number" : "variable";
-		tokens.push_back(Token(currentToken, type));
+	tokens.reserve(total);
+	for (const TokenBuffer& part : parts) {
+		tokens.replace(tokens.size(), tokens.size(), part);
 	}
-	return tokens;
 }
-bool TPostfix::validate() {
+std::vector<Token> TPostfix::tokenize() {
+	lex();
+	return GetTokens();
+}
+bool TPostfix::report(std::vector<ParseError>& errors, bool recover, ParseErrorKind kind, size_t offset, size_t length, const std::string& message) const {
+	ParseError error;
+	error.kind = kind;
+	error.offset = offset;
+	error.length = length;
+	error.message = message;
+	errors.push_back(error);
+	return recover;
+}
+bool TPostfix::report(std::vector<ParseError>& errors, bool recover, ParseErrorKind kind, size_t token, const std::string& message) const {
+	return report(errors, recover, kind, tokens.offsets[token], tokens.lengths[token], message);
+}
+//   recover  ,      
+bool TPostfix::check(std::vector<ParseError>& errors, bool recover) {
 	if (infix.empty()) {
-		throw std::invalid_argument("Expression is empty");
-	}		
-	tokenize();
+		report(errors, recover, ParseErrorKind::EmptyExpression, 0, 0, "Expression is empty");
+		return false;
+	}
+	lex();
 	if (tokens.empty()) {
-		throw std::invalid_argument("No tokens found in expression");
+		report(errors, recover, ParseErrorKind::EmptyExpression, 0, infix.size(), "No tokens found in expression");
+		return false;
 	}
-	TStack<int> bracketStack(tokens.size());
-	const Token* lastToken = nullptr;
-	for (size_t i = 0; i < tokens.size(); i++) {
-		const Token& token = tokens[i];
-		if (token.type == "variable") {
-			for (char c : token.value) {
-				if (!isVariableChar(c)) {
-					throw std::invalid_argument("Invalid character in variable name: " + token.value);
-				}
+	size_t count = std::min(threadCount(), tokens.size() / PARALLEL_CHECK_CHUNK);
+	bool structural = true;
+	if (count > 1 && checkParallel(0, tokens.size(), count, structural)) {
+		return !structural || checkTokens(0, tokens.size(), errors, recover, false);
+	}
+	return checkTokens(0, tokens.size(), errors, recover, true);
+}
+//   -   +1  '('  -1  ')':       ,
+//     ; true -      
+bool TPostfix::checkParallel(size_t first, size_t last, size_t count, bool& structural) {
+	struct TBlock {
+		int depth;
+		int lowest;
+		bool failed;
+		bool structural;
+	};
+	const unsigned char* kinds = tokens.kinds.data();
+	const unsigned char* ops = tokens.operators.data();
+	std::vector<TBlock> blocks(count);
+	parallelFor(taskPool(), count, [&](size_t k) {
+		size_t begin = first + (last - first) * k / count;
+		size_t end = first + (last - first) * (k + 1) / count;
+		TBlock block = { 0, 0, false, false };
+		for (size_t i = begin; i < end; i++) {
+			unsigned char kind = kinds[i];
+			unsigned char op = ops[i];
+			block.failed = block.failed || (kind == TOKEN_VARIABLE && op != 0) || (kind == TOKEN_OPERATOR && op == TOKEN_UNKNOWN_OPERATOR);
+			block.failed = block.failed || (i > first && checkAdjacent(kinds[i - 1], kind, op) != ADJACENT_OK);
+			block.depth += kind == TOKEN_OPEN ? 1 : kind == TOKEN_CLOSE ? -1 : 0;
+			block.lowest = std::min(block.lowest, block.depth);
+			block.structural = block.structural || kind == TOKEN_FUNCTION || kind == TOKEN_SEPARATOR ||
+				(kind == TOKEN_OPERATOR && (op == OPERATOR_QUESTION || op == OPERATOR_COLON));
+		}
+		blocks[k] = block;
+	});
+	int depth = 0;
+	structural = false;
+	for (const TBlock& block : blocks) {
+		if (block.failed || depth + block.lowest < 0) {
+			return false;
+		}
+		depth += block.depth;
+		structural = structural || block.structural;
+	}
+	bool opening = kinds[first] != TOKEN_OPERATOR || isPrefixOperator(kinds[first], ops[first]);
+	bool closing = kinds[last - 1] != TOKEN_OPERATOR && kinds[last - 1] != TOKEN_FUNCTION;
+	return depth == 0 && opening && closing;
+}
+// local = false:        ,   
+bool TPostfix::checkTokens(size_t first, size_t last, std::vector<ParseError>& errors, bool recover, bool local) {
+	const unsigned char* kinds = tokens.kinds.data();
+	const unsigned char* ops = tokens.operators.data();
+	size_t nesting = bracketNesting(kinds, first, last);
+	TPmrStack<int> bracketStack(nesting + 1, resource);
+	TPmrStack<int> separatorStack(nesting + 1, resource);
+	TPmrStack<int> conditionStack(nesting + 1, resource);
+	conditionStack.push(0);
+	for (size_t i = first; i < last; i++) {
+		unsigned char kind = kinds[i];
+		unsigned char op = ops[i];
+		if (local && kind == TOKEN_VARIABLE && op != 0) {
+			if (!report(errors, recover, ParseErrorKind::InvalidName, i, "Invalid character in variable name: " + tokenText(i))) {
+				return false;
+			}
+		}
+		if (local && kind == TOKEN_OPERATOR && op == TOKEN_UNKNOWN_OPERATOR) {
+			if (!report(errors, recover, ParseErrorKind::UnknownOperator, i, "Unknown operator: " + tokenText(i))) {
+				return false;
 			}
 		}
-		if (token.value == "(") {
+		if (kind == TOKEN_OPEN) {
 			bracketStack.push(i);
+			separatorStack.push(0);
+			conditionStack.push(0);
 		}
-		else if (token.value == ")") {
+		else if (kind == TOKEN_CLOSE) {
 			if (bracketStack.isEmpty()) {
-				throw std::invalid_argument("Unmatched closing bracket at position " + std::to_string(i));
+				if (!report(errors, recover, ParseErrorKind::UnmatchedBracket, i, "Unmatched closing bracket at position " + std::to_string(tokens.offsets[i]))) {
+					return false;
+				}
+			}
+			else {
+				if (conditionStack.pop() != 0) {
+					if (!report(errors, recover, ParseErrorKind::UnmatchedCondition, i, "Missing ':' in conditional before position " + std::to_string(tokens.offsets[i]))) {
+						return false;
+					}
+				}
+				int open = bracketStack.pop();
+				int separators = separatorStack.pop();
+				if (open > 0 && kinds[open - 1] == TOKEN_FUNCTION) {
+					size_t function = open - 1;
+					std::string name = tokenText(function);
+					int arguments = open + 1 == static_cast<int>(i) ? 0 : separators + 1;
+					int arity = functionArity(name);
+					size_t span = tokens.offsets[i] + 1 - tokens.offsets[function];
+					if (arity >= 0 && arguments != arity) {
+						if (!report(errors, recover, ParseErrorKind::ArgumentCount, tokens.offsets[function], span, "Function " + name + " expects " + std::to_string(arity) + " argument(s), got " + std::to_string(arguments))) {
+							return false;
+						}
+					}
+					if (arity < 0 && arguments < 1) {
+						if (!report(errors, recover, ParseErrorKind::ArgumentCount, tokens.offsets[function], span, "Function " + name + " expects at least 1 argument")) {
+							return false;
+						}
+					}
+					tokens.values[function] = arguments;
+				}
 			}
-			bracketStack.pop();
 		}
-		if (lastToken != nullptr) {
-			if (lastToken->type == "operator" && token.type == "operator") {
-				if (token.value != "-") {
-					throw std::invalid_argument("Two operators in a row " + lastToken->value + " " + token.value);
+		else if (kind == TOKEN_SEPARATOR) {
+			if (bracketStack.isEmpty() || bracketStack.peek() == 0 || kinds[bracketStack.peek() - 1] != TOKEN_FUNCTION) {
+				if (!report(errors, recover, ParseErrorKind::MisplacedSeparator, i, "Separator outside of function call at position " + std::to_string(tokens.offsets[i]))) {
+					return false;
 				}
 			}
-			if ((lastToken->type == "number" || lastToken->type == "variable") && (token.type == "number" || token.type == "variable")) {
-				throw std::invalid_argument("Missing operator between: " + lastToken->value + " and " + token.value);
+			else {
+				if (conditionStack.peek() != 0) {
+					if (!report(errors, recover, ParseErrorKind::UnmatchedCondition, i, "Missing ':' in conditional before position " + std::to_string(tokens.offsets[i]))) {
+						return false;
+					}
+					conditionStack.pop();
+					conditionStack.push(0);
+				}
+				separatorStack.push(separatorStack.pop() + 1);
 			}
-			if ((lastToken->type == "number" || lastToken->type == "variable") && token.value == "(") {
-				throw std::invalid_argument("Missing operator before opening bracket after: " + lastToken->value);
+		}
+		else if (kind == TOKEN_OPERATOR && op == OPERATOR_QUESTION) {
+			conditionStack.push(conditionStack.pop() + 1);
+		}
+		else if (kind == TOKEN_OPERATOR && op == OPERATOR_COLON) {
+			if (conditionStack.peek() == 0) {
+				if (!report(errors, recover, ParseErrorKind::UnmatchedCondition, i, "Missing '?' before ':' at position " + std::to_string(tokens.offsets[i]))) {
+					return false;
+				}
 			}
-			if (lastToken->type == "operator" && token.value == ")") {
-				throw std::invalid_argument("Missing operand before closing bracket after operator: " + lastToken->value);
+			else {
+				conditionStack.push(conditionStack.pop() - 1);
 			}
 		}
-		else {
-			if (token.type == "operator" && token.value != "-") {
-				throw std::invalid_argument("Expression cannot start with operator: " + token.value);
+		if (!local) {
+			continue;
+		}
+		TAdjacency adjacency = i > first ? checkAdjacent(kinds[i - 1], kind, op) : ADJACENT_OK;
+		if (adjacency != ADJACENT_OK) {
+			ParseErrorKind error = ParseErrorKind::MissingOperator;
+			size_t where = i;
+			std::string message;
+			switch (adjacency) {
+			case ADJACENT_TWO_OPERATORS:
+				error = ParseErrorKind::MissingOperand;
+				message = "Two operators in a row " + tokenText(i - 1) + " " + tokenText(i);
+				break;
+			case ADJACENT_NOT_AFTER_OPERAND:
+				message = "Missing operator before: " + tokenText(i);
+				break;
+			case ADJACENT_TWO_OPERANDS:
+				message = "Missing operator between: " + tokenText(i - 1) + " and " + tokenText(i);
+				break;
+			case ADJACENT_BRACKET_AFTER_OPERAND:
+				message = "Missing operator before opening bracket after: " + tokenText(i - 1);
+				break;
+			case ADJACENT_CLOSE_AFTER_OPERATOR:
+				error = ParseErrorKind::MissingOperand;
+				message = "Missing operand before closing bracket after operator: " + tokenText(i - 1);
+				break;
+			case ADJACENT_FUNCTION_WITHOUT_BRACKET:
+				error = ParseErrorKind::MissingBracket;
+				where = i - 1;
+				message = "Missing opening bracket after function: " + tokenText(i - 1);
+				break;
+			case ADJACENT_FUNCTION_AFTER_OPERAND:
+				message = "Missing operator before function: " + tokenText(i);
+				break;
+			case ADJACENT_SEPARATOR_WITHOUT_OPERAND:
+				error = ParseErrorKind::MissingOperand;
+				message = "Missing operand before separator at position " + std::to_string(tokens.offsets[i]);
+				break;
+			case ADJACENT_NOTHING_AFTER_SEPARATOR:
+				error = ParseErrorKind::MissingOperand;
+				message = "Missing operand after separator at position " + std::to_string(tokens.offsets[i]);
+				break;
+			case ADJACENT_OK:
+				break;
+			}
+			if (!report(errors, recover, error, where, message)) {
+				return false;
+			}
+		}
+		else if (i == first) {
+			if (kind == TOKEN_OPERATOR && !isPrefixOperator(kind, op)) {
+				if (!report(errors, recover, ParseErrorKind::MissingOperand, i, "Expression cannot start with operator: " + tokenText(i))) {
+					return false;
+				}
 			}
 		}
-		lastToken = &token;
 	}
-	if (!bracketStack.isEmpty()) {
-		throw std::invalid_argument("Unmatched opening bracket");
+	while (!bracketStack.isEmpty()) {
+		if (!report(errors, recover, ParseErrorKind::UnmatchedBracket, bracketStack.pop(), "Unmatched opening bracket")) {
+			return false;
+		}
+		conditionStack.pop();
+	}
+	if (conditionStack.pop() != 0) {
+		if (!report(errors, recover, ParseErrorKind::UnmatchedCondition, infix.size(), 0, "Missing ':' in conditional")) {
+			return false;
+		}
+	}
+	if (kinds[last - 1] == TOKEN_OPERATOR) {
+		report(errors, recover, ParseErrorKind::MissingOperand, last - 1, "Expression cannot end with operator: " + tokenText(last - 1));
+	}
+	if (kinds[last - 1] == TOKEN_FUNCTION) {
+		report(errors, recover, ParseErrorKind::MissingBracket, last - 1, "Missing opening bracket after function: " + tokenText(last - 1));
+	}
+	return errors.empty();
+}
+bool TPostfix::validate() {
+	std::vector<ParseError> errors;
+	if (!check(errors, false)) {
+		throw std::invalid_argument(errors.front().message);
+	}
+	return true;
+}
+std::vector<ParseError> TPostfix::diagnose() {
+	std::vector<ParseError> errors;
+	if (check(errors, true)) {
+		order();
+	}
+	return errors;
+}
+bool TPostfix::parse(ParseError& error) {
+	std::vector<ParseError> errors;
+	if (!check(errors, false)) {
+		error = errors.front();
+		return false;
 	}
-	if (!tokens.empty() && tokens.back().type == "operator") {
-		throw std::invalid_argument("Expression cannot end with operator: " + tokens.back().value);
-	}	
+	order();
 	return true;
 }
-std::string TPostfix::toPostfix() {
-	validate();
-	TStack<std::string> stack(tokens.size());
-	postfix = "";
-	for (const Token& token : tokens) {
-		if (token.type == "number" || token.type == "variable") {
-			postfix += token.value + " ";
+void TPostfix::order() {
+	postfixOrder.clear();
+	postfixOrder.reserve(tokens.size());
+	orderTokens(0, tokens.size(), postfixOrder);
+	writePostfix();
+}
+//        
+void TPostfix::orderTokens(size_t first, size_t last, std::vector<int>& output) const {
+	const unsigned char* kinds = tokens.kinds.data();
+	const unsigned char* ops = tokens.operators.data();
+	const unsigned char* precedences = tokens.precedences.data();
+	TPmrStack<int> stack(ORDER_STACK_CAPACITY, resource);
+	for (size_t i = first; i < last; i++) {
+		unsigned char kind = kinds[i];
+		if (kind == TOKEN_NUMBER || kind == TOKEN_VARIABLE) {
+			output.push_back(static_cast<int>(i));
 		}
-		else if (token.value == "(") {
-			stack.push(token.value);
+		else if (kind == TOKEN_OPEN || kind == TOKEN_FUNCTION) {
+			stack.push(static_cast<int>(i));
 		}
-		else if (token.value == ")") {
-			while (!stack.isEmpty() && stack.peek() != "(") {
-				postfix += stack.pop() + " ";
+		else if (kind == TOKEN_SEPARATOR) {
+			while (!stack.isEmpty() && kinds[stack.peek()] != TOKEN_OPEN) {
+				output.push_back(stack.pop());
 			}
-			if (!stack.isEmpty() && stack.peek() == "(") {
+		}
+		else if (kind == TOKEN_CLOSE) {
+			while (!stack.isEmpty() && kinds[stack.peek()] != TOKEN_OPEN) {
+				output.push_back(stack.pop());
+			}
+			if (!stack.isEmpty()) {
 				stack.pop();
 			}
+			if (!stack.isEmpty() && kinds[stack.peek()] == TOKEN_FUNCTION) {
+				output.push_back(stack.pop());
+			}
+		}
+		else if (ops[i] == OPERATOR_COLON) {
+			while (ops[stack.peek()] != OPERATOR_QUESTION || kinds[stack.peek()] != TOKEN_OPERATOR) {
+				output.push_back(stack.pop());
+			}
+			stack.pop();
+			stack.push(static_cast<int>(i));
+		}
+		else if (ops[i] == OPERATOR_NOT || ops[i] == OPERATOR_QUESTION) {
+			while (ops[i] == OPERATOR_QUESTION && !stack.isEmpty() && kinds[stack.peek()] != TOKEN_OPEN && precedences[stack.peek()] > precedences[i]) {
+				output.push_back(stack.pop());
+			}
+			stack.push(static_cast<int>(i));
 		}
-		else if (token.type == "operator") {
-			while (!stack.isEmpty() && stack.peek() != "(" && priority[stack.peek()[0]] >= priority[token.value[0]]) {
-				postfix += stack.pop() + " ";
+		else {
+			while (!stack.isEmpty() && kinds[stack.peek()] != TOKEN_OPEN && precedences[stack.peek()] >= precedences[i]) {
+				output.push_back(stack.pop());
 			}
-			stack.push(token.value);
+			stack.push(static_cast<int>(i));
 		}
 	}
 	while (!stack.isEmpty()) {
-		postfix += stack.pop() + " ";
+		output.push_back(stack.pop());
+	}
+}
+void TPostfix::writePostfix() {
+	size_t length = 0;
+	for (int index : postfixOrder) {
+		length += tokens.lengths[index] + 1;
+	}
+	postfix.clear();
+	postfix.reserve(length);
+	program = CompiledExpression();
+	for (int index : postfixOrder) {
+		if (!postfix.empty()) {
+			postfix += ' ';
+		}
+		if (tokens.kinds[index] == TOKEN_OPERATOR && tokens.operators[index] == OPERATOR_COLON) {
+			postfix += "?:";
+		}
+		else {
+			postfix.append(infix, tokens.offsets[index], tokens.lengths[index]);
+		}
+	}
+}
+bool TPostfix::applyEdit(size_t offset, size_t removedLength, const std::string& insertedText) {
+	if (offset > infix.size() || removedLength > infix.size() - offset) {
+		throw std::invalid_argument("Edit is out of expression bounds");
+	}
+	if (postfix.empty()) {
+		setInfix(infix.substr(0, offset) + insertedText + infix.substr(offset + removedLength));
+		return false;
+	}
+	infix.replace(offset, removedLength, insertedText);
+	program = CompiledExpression();
+	//   [start, oldEnd)   [start, newEnd)
+	size_t start = 0;
+	while (start < tokens.size() && tokens.offsets[start] < offset) {
+		start++;
+	}
+	start = start > 0 ? start - 1 : 0;
+	long long shift = static_cast<long long>(insertedText.size()) - static_cast<long long>(removedLength);
+	size_t editEnd = offset + insertedText.size();
+	const char* end = infix.data() + infix.size();
+	const char* p = infix.data() + (start < tokens.size() ? std::min<size_t>(tokens.offsets[start], offset) : offset);
+	p = skipSpaces(p, end);
+	TokenBuffer window;
+	size_t oldEnd = start;
+	while (oldEnd < tokens.size() && tokens.offsets[oldEnd] < offset + removedLength) {
+		oldEnd++;
+	}
+	bool synchronized = false;
+	while (p < end && !synchronized) {
+		TokenKind previous = !window.empty() ? static_cast<TokenKind>(window.kinds.back()) :
+			start > 0 ? static_cast<TokenKind>(tokens.kinds[start - 1]) : TOKEN_OPEN;
+		p = skipSpaces(lexToken(p, end, previous, window), end);
+		size_t last = window.size() - 1;
+		long long position = window.offsets[last];
+		if (window.offsets[last] < editEnd) {
+			continue;
+		}
+		while (oldEnd < tokens.size() && tokens.offsets[oldEnd] + shift < position) {
+			oldEnd++;
+		}
+		//     ,      
+		if (oldEnd < tokens.size() && tokens.offsets[oldEnd] + shift == position && tokens.kinds[oldEnd] == window.kinds[last] &&
+			tokens.operators[oldEnd] == window.operators[last] && tokens.lengths[oldEnd] == window.lengths[last]) {
+			window.pop();
+			synchronized = true;
+		}
+	}
+	if (!synchronized) {
+		oldEnd = tokens.size();
+	}
+	bool local = isLocalEdit(tokens, start, oldEnd) && isLocalEdit(window, 0, window.size());
+	size_t newEnd = start + window.size();
+	long long tokenShift = static_cast<long long>(window.size()) - static_cast<long long>(oldEnd - start);
+	tokens.shift(oldEnd, shift);
+	tokens.replace(start, oldEnd, window);
+	//   ,   
+	size_t open = start;
+	int depth = 0;
+	while (local && open > 0 && depth >= 0) {
+		open--;
+		depth += tokens.kinds[open] == TOKEN_CLOSE ? 1 : tokens.kinds[open] == TOKEN_OPEN ? -1 : 0;
+	}
+	size_t close = newEnd;
+	int closeDepth = 0;
+	while (local && depth < 0 && close < tokens.size()) {
+		closeDepth += tokens.kinds[close] == TOKEN_OPEN ? 1 : tokens.kinds[close] == TOKEN_CLOSE ? -1 : 0;
+		if (closeDepth < 0) {
+			break;
+		}
+		close++;
+	}
+	std::vector<ParseError> errors;
+	if (!local || depth >= 0 || close == tokens.size()) {
+		if (tokens.empty() || !checkTokens(0, tokens.size(), errors, false, true)) {
+			postfix.clear();
+			postfixOrder.clear();
+			return false;
+		}
+		order();
+		return true;
+	}
+	if (!checkTokens(open, close + 1, errors, false, true)) {
+		postfix.clear();
+		postfixOrder.clear();
+		return false;
+	}
+	std::vector<int> segment;
+	orderTokens(open + 1, close, segment);
+	long long oldClose = static_cast<long long>(close) - tokenShift;
+	std::vector<int> result;
+	result.reserve(postfixOrder.size() + segment.size());
+	bool inserted = false;
+	for (int index : postfixOrder) {
+		if (index > static_cast<int>(open) && index < oldClose) {
+			if (!inserted) {
+				result.insert(result.end(), segment.begin(), segment.end());
+				inserted = true;
+			}
+			continue;
+		}
+		result.push_back(index >= static_cast<int>(oldEnd) ? static_cast<int>(index + tokenShift) : index);
 	}
-	if (!postfix.empty() && postfix.back() == ' ') {
-		postfix.pop_back();
+	postfixOrder.swap(result);
+	writePostfix();
+	return true;
+}
+std::string TPostfix::toPostfix() {
+	ParseError error;
+	if (!parse(error)) {
+		throw std::invalid_argument(error.message);
 	}
 	return postfix;
 }
-double TPostfix::calculate() {
+const std::vector<int>& TPostfix::GetPostfixOrder() {
 	if (postfix.empty()) {
 		toPostfix();
 	}
-	TStack<double> stack(tokens.size());
-	std::stringstream ss(postfix);
-	std::string token;
-	while (ss >> token) {
-		if (isNumber(token)) {
-			stack.push(std::stod(token));
-		}
-		else if (isVariableChar(token[0])) {
-			auto it = variables.find(token);
-			if (it == variables.end()) {
-				throw std::invalid_argument("Underfined variable: " + token);
-			}
-			stack.push(it->second);
-		}
-		else if (isOperator(token[0])) {
-			if (stack.GetSize() < 2) {
-				throw std::invalid_argument("Not enough operands for operator: " + token);
-			}
-			double b = stack.pop();
-			double a = stack.pop();
-			double result = 0.0;
-			switch (token[0]) {
-			case '+':
-				result = a + b; break;
-			case '-':
-				result = a - b; break;
-			case '*':
-				result = a * b; break;
-			case '/':
-				if (b == 0) throw std::runtime_error("Division by zero");
-				result = a / b;
-				break;
-			case '^':
-				result = std::pow(a, b);
-				break;
-			default:
-				throw std::invalid_argument("Unknown operator: " + token);
+	return postfixOrder;
+}
+void TPostfix::generate() {
+	CompiledExpression result;
+	std::map<std::string, int> nameIndex;
+	bool conditional = false;
+	result.code.reserve(postfixOrder.size());
+	for (int index : postfixOrder) {
+		unsigned char kind = tokens.kinds[index];
+		Instruction instruction = { OpCode::Number, 0 };
+		if (kind == TOKEN_NUMBER) {
+			instruction.arg = static_cast<int>(result.constants.size());
+			result.constants.push_back(tokens.constants[tokens.values[index]]);
+		}
+		else if (kind == TOKEN_VARIABLE) {
+			std::string name = tokenText(index);
+			instruction.op = OpCode::Variable;
+			auto it = nameIndex.find(name);
+			if (it == nameIndex.end()) {
+				it = nameIndex.insert(std::make_pair(name, static_cast<int>(result.names.size()))).first;
+				result.names.push_back(name);
+			}
+			instruction.arg = it->second;
+		}
+		else if (kind == TOKEN_FUNCTION && findBuiltin(tokenText(index)) != nullptr) {
+			const TBuiltinFunction* function = findBuiltin(tokenText(index));
+			instruction.op = function->op;
+			int count = function->arity < 0 ? static_cast<int>(tokens.values[index]) - 1 : 1;
+			for (int j = 0; j < count; j++) {
+				result.code.push_back(instruction);
+			}
+			continue;
+		}
+		else if (kind == TOKEN_FUNCTION) {
+			const TNativeFunction* function = functions.find(tokenText(index));
+			if ((function->flags & FUNCTION_CONSTANT_FOLDABLE) && foldableCall(result, function->arity)) {
+				std::vector<double> arguments(result.constants.end() - function->arity, result.constants.end());
+				result.code.resize(result.code.size() - function->arity);
+				result.constants.resize(result.constants.size() - function->arity);
+				instruction.arg = static_cast<int>(result.constants.size());
+				result.constants.push_back(function->scalar(arguments.data()));
+				result.code.push_back(instruction);
+				continue;
+			}
+			instruction.op = OpCode::Call;
+			instruction.arg = static_cast<int>(result.functions.size());
+			for (size_t j = 0; j < result.functions.size(); j++) {
+				if (result.functions[j].name == function->name) {
+					instruction.arg = static_cast<int>(j);
+				}
+			}
+			if (static_cast<size_t>(instruction.arg) == result.functions.size()) {
+				FunctionReference reference = { function->name, function->arity };
+				result.functions.push_back(reference);
+			}
+		}
+		else {
+			if (tokens.operators[index] == TOKEN_UNKNOWN_OPERATOR) {
+				throw std::invalid_argument("Unknown operator: " + tokenText(index));
+			}
+			instruction.op = OPERATORS[tokens.operators[index]].op;
+		}
+		if (instruction.op == OpCode::Pow && !result.code.empty() && result.code.back().op == OpCode::Number) {
+			double exponent = result.constants[result.code.back().arg];
+			if (exponent == std::trunc(exponent) && std::fabs(exponent) <= POW_INT_LIMIT) {
+				result.code.pop_back();
+				result.constants.pop_back();
+				instruction.op = OpCode::PowInt;
+				instruction.arg = static_cast<int>(exponent);
 			}
-			stack.push(result);
 		}
+		result.code.push_back(instruction);
+		conditional = conditional || instruction.op == OpCode::Select || instruction.op == OpCode::And || instruction.op == OpCode::Or;
+	}
+	if (reassociation != Reassociation::Strict) {
+		reassociate(result, reassociation, resource);
+	}
+	if (conditional) {
+		insertJumps(result, resource);
+	}
+	result.stackDepth = maxStackDepth(result);
+	program = std::move(result);
+}
+const CompiledExpression& TPostfix::compile() {
+	if (!program.code.empty()) {
+		return program;
 	}
-	if (stack.GetSize() != 1) {
-		throw std::invalid_argument("Invalid expression");
+	ParseError error;
+	if (postfix.empty() && !parse(error)) {
+		throw std::invalid_argument(error.message);
 	}
-	return stack.pop();
+	generate();
+	return program;
+}
+size_t TPostfix::GetStackDepth() {
+	return compile().stackDepth;
+}
+TExpected<CompiledExpression, ParseError> TPostfix::compile(std::string_view expression, const TFunctionTable& table,
+	Reassociation mode) {
+	TPostfix parser{ std::string(expression) };
+	parser.functions = table;
+	parser.reassociation = mode;
+	ParseError error;
+	if (!parser.parse(error)) {
+		return makeUnexpected(error);
+	}
+	parser.generate();
+	return std::move(parser.program);
+}
+double TPostfix::calculate() {
+	compile();
+	if (threadCount() > 1) {
+		return evaluateProgramParallel<double>(program, bindVariables<double>(program, variables), bindFunctions(program, functions),
+			taskPool(), resource);
+	}
+	return evaluateProgram<double>(program, bindVariables<double>(program, variables), bindFunctions(program, functions), resource);
+}
+void TPostfix::calculateBatch(const std::map<std::string, const double*>& columns, size_t rows, double* result) {
+	compile();
+	std::vector<const double*> sources;
+	std::vector<double> scalars;
+	bindColumns<double>(program, columns, variables, sources, scalars);
+	evaluateProgramBatch<double>(program, sources, scalars, bindFunctions(program, functions), rows, result, nullptr, nullptr,
+		resource);
+}
+TBatchReport TPostfix::calculateBatch(const std::map<std::string, const double*>& columns, size_t rows, double* result,
+	const TBatchOptions& options) {
+	try {
+		compile();
+	}
+	catch (const std::exception& error) {
+		TBatchReport report;
+		report.status = BatchStatus::InvalidExpression;
+		report.message = error.what();
+		return report;
+	}
+	return evaluateProgramBatchReport<double>(program, columns, variables, functions, rows, result, options, resource);
+}
+std::vector<double> TPostfix::calculateBatch(const TColumnFile& input) {
+	std::map<std::string, const double*> columns;
+	for (size_t i = 0; i < input.GetColumnCount(); i++) {
+		columns[input.GetName(i)] = input.GetColumn(i);
+	}
+	std::vector<double> result(input.GetRowCount());
+	calculateBatch(columns, result.size(), result.data());
+	return result;
 }
 std::vector<Token> TPostfix::GetTokens() const {
-	return tokens;
+	const char* types[] = { "number", "variable", "function", "operator", "bracket", "bracket", "separator" };
+	std::vector<Token> result;
+	result.reserve(tokens.size());
+	for (size_t i = 0; i < tokens.size(); i++) {
+		unsigned char kind = tokens.kinds[i];
+		double number = kind == TOKEN_NUMBER ? tokens.constants[tokens.values[i]] : 0.0;
+		result.push_back(Token(tokenText(i), types[kind], number, tokens.offsets[i]));
+		result.back().arity = kind == TOKEN_FUNCTION ? static_cast<int>(tokens.values[i]) : 0;
+	}
+	return result;
 }
 
@@ -0,0 +1,210 @@
+//    
+#include "columns.h"
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define TPCOLS_MMAP 1
+#endif
+namespace {
+const char COLUMN_MAGIC[8] = { 'T', 'P', 'C', 'O', 'L', 'S', '0', '1' };
+const size_t COLUMN_HEADER_SIZE = 24;
+bool isLittleEndian() {
+	const uint16_t probe = 1;
+	unsigned char first;
+	std::memcpy(&first, &probe, 1);
+	return first == 1;
+}
+uint64_t readLE(const unsigned char* p, int bytes) {
+	uint64_t value = 0;
+	for (int i = bytes - 1; i >= 0; i--) {
+		value = (value << 8) | p[i];
+	}
+	return value;
+}
+void writeLE(std::ofstream& out, uint64_t value, int bytes) {
+	char buf[8];
+	for (int i = 0; i < bytes; i++) {
+		buf[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+	}
+	out.write(buf, bytes);
+}
+size_t alignTo8(size_t offset) {
+	return (offset + 7) & ~static_cast<size_t>(7);
+}
+}
+TColumnFile::TColumnFile() : rows(0), mapping(nullptr), mappingSize(0) {}
+TColumnFile::TColumnFile(const std::string& path) : rows(0), mapping(nullptr), mappingSize(0) {
+	open(path);
+}
+TColumnFile::~TColumnFile() {
+	release();
+}
+void TColumnFile::release() {
+#ifdef TPCOLS_MMAP
+	if (mapping != nullptr) {
+		munmap(mapping, mappingSize);
+	}
+#endif
+	mapping = nullptr;
+	mappingSize = 0;
+	names.clear();
+	columns.clear();
+	storage.clear();
+	rows = 0;
+}
+void TColumnFile::open(const std::string& path) {
+	release();
+#ifdef TPCOLS_MMAP
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		throw std::runtime_error("Cannot open column file: " + path);
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		::close(fd);
+		throw std::runtime_error("Cannot read column file: " + path);
+	}
+	size_t size = static_cast<size_t>(st.st_size);
+	void* data = size > 0 ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+	::close(fd);
+	if (data == MAP_FAILED) {
+		throw std::runtime_error("Cannot map column file: " + path);
+	}
+	mapping = data;
+	mappingSize = size;
+	try {
+		parse(static_cast<const unsigned char*>(data), size, isLittleEndian());
+	}
+	catch (...) {
+		release();
+		throw;
+	}
+#else
+	std::ifstream in(path, std::ios::binary | std::ios::ate);
+	if (!in) {
+		throw std::runtime_error("Cannot open column file: " + path);
+	}
+	size_t size = static_cast<size_t>(in.tellg());
+	std::vector<double> buffer((size + sizeof(double) - 1) / sizeof(double));
+	in.seekg(0);
+	in.read(reinterpret_cast<char*>(buffer.data()), size);
+	if (!in) {
+		throw std::runtime_error("Cannot read column file: " + path);
+	}
+	storage.swap(buffer);
+	try {
+		parse(reinterpret_cast<const unsigned char*>(storage.data()), size, isLittleEndian());
+	}
+	catch (...) {
+		release();
+		throw;
+	}
+#endif
+}
+void TColumnFile::parse(const unsigned char* data, size_t size, bool zeroCopy) {
+	if (size < COLUMN_HEADER_SIZE || std::memcmp(data, COLUMN_MAGIC, sizeof(COLUMN_MAGIC)) != 0) {
+		throw std::runtime_error("Invalid column file header");
+	}
+	size_t count = static_cast<size_t>(readLE(data + 8, 4));
+	rows = readLE(data + 16, 8);
+	size_t offset = COLUMN_HEADER_SIZE;
+	for (size_t i = 0; i < count; i++) {
+		if (offset + 4 > size) {
+			throw std::runtime_error("Truncated column file");
+		}
+		size_t length = static_cast<size_t>(readLE(data + offset, 4));
+		offset += 4;
+		if (offset + length > size) {
+			throw std::runtime_error("Truncated column file");
+		}
+		names.push_back(std::string(reinterpret_cast<const char*>(data + offset), length));
+		offset += length;
+	}
+	offset = alignTo8(offset);
+	if (offset > size || (rows != 0 && (size - offset) / sizeof(double) / rows < count)) {
+		throw std::runtime_error("Truncated column file");
+	}
+	size_t n = static_cast<size_t>(rows);
+	if (zeroCopy) {
+		for (size_t i = 0; i < count; i++) {
+			columns.push_back(reinterpret_cast<const double*>(data + offset + i * n * sizeof(double)));
+		}
+		return;
+	}
+	std::vector<double> converted(count * n);
+	for (size_t i = 0; i < count * n; i++) {
+		uint64_t bits = readLE(data + offset + i * sizeof(double), 8);
+		std::memcpy(&converted[i], &bits, sizeof(double));
+	}
+	storage.swap(converted);
+	for (size_t i = 0; i < count; i++) {
+		columns.push_back(storage.data() + i * n);
+	}
+}
+size_t TColumnFile::GetRowCount() const {
+	return static_cast<size_t>(rows);
+}
+size_t TColumnFile::GetColumnCount() const {
+	return names.size();
+}
+const std::string& TColumnFile::GetName(size_t index) const {
+	if (index >= names.size()) {
+		throw std::out_of_range("Column index out of range");
+	}
+	return names[index];
+}
+const double* TColumnFile::GetColumn(size_t index) const {
+	if (index >= columns.size()) {
+		throw std::out_of_range("Column index out of range");
+	}
+	return columns[index];
+}
+const double* TColumnFile::find(const std::string& name) const {
+	for (size_t i = 0; i < names.size(); i++) {
+		if (names[i] == name) {
+			return columns[i];
+		}
+	}
+	return nullptr;
+}
+void TColumnFile::write(const std::string& path, const std::vector<std::string>& names, const std::vector<const double*>& columns, size_t rows) {
+	if (names.size() != columns.size()) {
+		throw std::invalid_argument("Column names and data count mismatch");
+	}
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	if (!out) {
+		throw std::runtime_error("Cannot create column file: " + path);
+	}
+	out.write(COLUMN_MAGIC, sizeof(COLUMN_MAGIC));
+	writeLE(out, names.size(), 4);
+	writeLE(out, 0, 4);
+	writeLE(out, rows, 8);
+	size_t offset = COLUMN_HEADER_SIZE;
+	for (const std::string& name : names) {
+		writeLE(out, name.size(), 4);
+		out.write(name.data(), name.size());
+		offset += 4 + name.size();
+	}
+	const char padding[8] = { 0 };
+	out.write(padding, alignTo8(offset) - offset);
+	bool little = isLittleEndian();
+	for (const double* column : columns) {
+		if (little) {
+			out.write(reinterpret_cast<const char*>(column), rows * sizeof(double));
+			continue;
+		}
+		for (size_t i = 0; i < rows; i++) {
+			uint64_t bits;
+			std::memcpy(&bits, &column[i], sizeof(double));
+			writeLE(out, bits, 8);
+		}
+	}
+	if (!out) {
+		throw std::runtime_error("Cannot write column file: " + path);
+	}
+}
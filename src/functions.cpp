@@ -0,0 +1,42 @@
+//    
+#include "functions.h"
+#include <cctype>
+#include <stdexcept>
+void TFunctionTable::add(const std::string& name, int arity, ScalarFunction scalar, unsigned flags) {
+	add(name, arity, scalar, BlockFunction(), flags & ~FUNCTION_VECTORIZABLE);
+}
+void TFunctionTable::add(const std::string& name, int arity, ScalarFunction scalar, BlockFunction block, unsigned flags) {
+	if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0]))) {
+		throw std::invalid_argument("Invalid function name: " + name);
+	}
+	for (char c : name) {
+		if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_') {
+			throw std::invalid_argument("Invalid function name: " + name);
+		}
+	}
+	if (isBuiltinFunction(name) || find(name) != nullptr) {
+		throw std::invalid_argument("Function already defined: " + name);
+	}
+	if (arity < 0 || !scalar) {
+		throw std::invalid_argument("Invalid function definition: " + name);
+	}
+	if ((flags & FUNCTION_CONSTANT_FOLDABLE) && !(flags & FUNCTION_PURE)) {
+		throw std::invalid_argument("Constant folding requires a pure function: " + name);
+	}
+	if (!block) {
+		flags &= ~FUNCTION_VECTORIZABLE;
+	}
+	TNativeFunction function = { name, arity, flags, scalar, block };
+	functions.push_back(function);
+}
+const TNativeFunction* TFunctionTable::find(const std::string& name) const {
+	for (const TNativeFunction& function : functions) {
+		if (function.name == name) {
+			return &function;
+		}
+	}
+	return nullptr;
+}
+size_t TFunctionTable::GetCount() const {
+	return functions.size();
+}
@@ -0,0 +1,236 @@
+//      
+#include "library.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+namespace {
+const char LIBRARY_MAGIC[4] = { 'T', 'P', 'L', 'B' };
+const size_t LIBRARY_HEADER_SIZE = 16;
+uint32_t checksum(const unsigned char* data, size_t size) {
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= data[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+void putLE(std::vector<unsigned char>& out, uint64_t value, int bytes) {
+	for (int i = 0; i < bytes; i++) {
+		out.push_back(static_cast<unsigned char>((value >> (8 * i)) & 0xFF));
+	}
+}
+class TReader {
+private:
+	const unsigned char* data;
+	size_t size;
+	size_t offset;
+public:
+	TReader(const unsigned char* d, size_t s, size_t o) : data(d), size(s), offset(o) {}
+	uint64_t get(int bytes) {
+		if (size - offset < static_cast<size_t>(bytes)) {
+			throw std::runtime_error("Truncated formula library");
+		}
+		uint64_t value = 0;
+		for (int i = bytes - 1; i >= 0; i--) {
+			value = (value << 8) | data[offset + i];
+		}
+		offset += bytes;
+		return value;
+	}
+	std::string getString(size_t length) {
+		if (size - offset < length) {
+			throw std::runtime_error("Truncated formula library");
+		}
+		std::string value(reinterpret_cast<const char*>(data + offset), length);
+		offset += length;
+		return value;
+	}
+};
+//     
+size_t check(const CompiledExpression& program) {
+	std::vector<int> depthAt(program.code.size() + 1, -1);
+	int depth = 0;
+	int deepest = 0;
+	bool reachable = true;
+	for (size_t pc = 0; pc <= program.code.size(); pc++) {
+		if (depthAt[pc] >= 0) {
+			if (reachable && depthAt[pc] != depth) {
+				throw std::runtime_error("Inconsistent stack depth in formula library");
+			}
+			depth = depthAt[pc];
+			reachable = true;
+		}
+		else if (!reachable) {
+			throw std::runtime_error("Unreachable instruction in formula library");
+		}
+		if (pc == program.code.size()) {
+			break;
+		}
+		const Instruction& instruction = program.code[pc];
+		switch (instruction.op) {
+		case OpCode::Number:
+			if (instruction.arg < 0 || static_cast<size_t>(instruction.arg) >= program.constants.size()) {
+				throw std::runtime_error("Constant index out of range in formula library");
+			}
+			depth++;
+			break;
+		case OpCode::Variable:
+			if (instruction.arg < 0 || static_cast<size_t>(instruction.arg) >= program.names.size()) {
+				throw std::runtime_error("Variable index out of range in formula library");
+			}
+			depth++;
+			break;
+		case OpCode::JumpIfZero:
+		case OpCode::Jump:
+		case OpCode::AndJump:
+		case OpCode::OrJump: {
+			if (instruction.arg <= static_cast<int>(pc) || static_cast<size_t>(instruction.arg) > program.code.size()) {
+				throw std::runtime_error("Jump target out of range in formula library");
+			}
+			if (instruction.op != OpCode::Jump && depth < 1) {
+				throw std::runtime_error("Not enough operands in formula library");
+			}
+			int target = instruction.op == OpCode::JumpIfZero ? depth - 1 : depth;
+			if (depthAt[instruction.arg] >= 0 && depthAt[instruction.arg] != target) {
+				throw std::runtime_error("Inconsistent stack depth in formula library");
+			}
+			depthAt[instruction.arg] = target;
+			if (instruction.op == OpCode::JumpIfZero) {
+				depth--;
+			}
+			reachable = instruction.op != OpCode::Jump;
+			break;
+		}
+		case OpCode::Call:
+			if (instruction.arg < 0 || static_cast<size_t>(instruction.arg) >= program.functions.size()) {
+				throw std::runtime_error("Function index out of range in formula library");
+			}
+			[[fallthrough]];
+		default:
+			int operands = operandCount(program, instruction);
+			if (operands < 0) {
+				throw std::runtime_error("Unknown opcode in formula library");
+			}
+			if (depth < operands) {
+				throw std::runtime_error("Not enough operands in formula library");
+			}
+			depth += 1 - operands;
+			break;
+		}
+		deepest = std::max(deepest, depth);
+	}
+	if (depth != 1) {
+		throw std::runtime_error("Invalid program in formula library");
+	}
+	return deepest;
+}
+}
+std::vector<unsigned char> TFormulaLibrary::serialize(const std::vector<CompiledExpression>& programs) {
+	std::vector<unsigned char> out(LIBRARY_MAGIC, LIBRARY_MAGIC + sizeof(LIBRARY_MAGIC));
+	putLE(out, VERSION, 4);
+	putLE(out, programs.size(), 4);
+	putLE(out, 0, 4);
+	for (const CompiledExpression& program : programs) {
+		putLE(out, program.code.size(), 4);
+		putLE(out, program.constants.size(), 4);
+		putLE(out, program.names.size(), 4);
+		putLE(out, program.functions.size(), 4);
+		for (const Instruction& instruction : program.code) {
+			putLE(out, static_cast<unsigned char>(instruction.op), 1);
+			putLE(out, static_cast<uint32_t>(instruction.arg), 4);
+		}
+		for (double constant : program.constants) {
+			uint64_t bits;
+			std::memcpy(&bits, &constant, sizeof(double));
+			putLE(out, bits, 8);
+		}
+		for (const std::string& name : program.names) {
+			putLE(out, name.size(), 4);
+			out.insert(out.end(), name.begin(), name.end());
+		}
+		for (const FunctionReference& function : program.functions) {
+			putLE(out, static_cast<uint32_t>(function.arity), 4);
+			putLE(out, function.name.size(), 4);
+			out.insert(out.end(), function.name.begin(), function.name.end());
+		}
+	}
+	uint32_t sum = checksum(out.data() + LIBRARY_HEADER_SIZE, out.size() - LIBRARY_HEADER_SIZE);
+	for (int i = 0; i < 4; i++) {
+		out[12 + i] = static_cast<unsigned char>((sum >> (8 * i)) & 0xFF);
+	}
+	return out;
+}
+std::vector<CompiledExpression> TFormulaLibrary::deserialize(const unsigned char* data, size_t size) {
+	if (size < LIBRARY_HEADER_SIZE || std::memcmp(data, LIBRARY_MAGIC, sizeof(LIBRARY_MAGIC)) != 0) {
+		throw std::runtime_error("Invalid formula library header");
+	}
+	TReader header(data, size, sizeof(LIBRARY_MAGIC));
+	uint64_t version = header.get(4);
+	if (version < 1 || version > VERSION) {
+		throw std::runtime_error("Unsupported formula library version");
+	}
+	size_t count = static_cast<size_t>(header.get(4));
+	if (header.get(4) != checksum(data + LIBRARY_HEADER_SIZE, size - LIBRARY_HEADER_SIZE)) {
+		throw std::runtime_error("Formula library checksum mismatch");
+	}
+	TReader reader(data, size, LIBRARY_HEADER_SIZE);
+	std::vector<CompiledExpression> programs;
+	for (size_t i = 0; i < count; i++) {
+		CompiledExpression program;
+		size_t codeCount = static_cast<size_t>(reader.get(4));
+		size_t constantCount = static_cast<size_t>(reader.get(4));
+		size_t nameCount = static_cast<size_t>(reader.get(4));
+		size_t functionCount = version >= 2 ? static_cast<size_t>(reader.get(4)) : 0;
+		for (size_t j = 0; j < codeCount; j++) {
+			Instruction instruction;
+			instruction.op = static_cast<OpCode>(reader.get(1));
+			instruction.arg = static_cast<int>(static_cast<uint32_t>(reader.get(4)));
+			program.code.push_back(instruction);
+		}
+		for (size_t j = 0; j < constantCount; j++) {
+			uint64_t bits = reader.get(8);
+			double constant;
+			std::memcpy(&constant, &bits, sizeof(double));
+			program.constants.push_back(constant);
+		}
+		for (size_t j = 0; j < nameCount; j++) {
+			size_t length = static_cast<size_t>(reader.get(4));
+			program.names.push_back(reader.getString(length));
+		}
+		for (size_t j = 0; j < functionCount; j++) {
+			FunctionReference function;
+			function.arity = static_cast<int>(static_cast<uint32_t>(reader.get(4)));
+			size_t length = static_cast<size_t>(reader.get(4));
+			function.name = reader.getString(length);
+			if (function.arity < 0) {
+				throw std::runtime_error("Invalid function arity in formula library");
+			}
+			program.functions.push_back(function);
+		}
+		program.stackDepth = check(program);
+		programs.push_back(program);
+	}
+	return programs;
+}
+void TFormulaLibrary::save(const std::string& path, const std::vector<CompiledExpression>& programs) {
+	std::vector<unsigned char> data = serialize(programs);
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	out.write(reinterpret_cast<const char*>(data.data()), data.size());
+	if (!out) {
+		throw std::runtime_error("Cannot write formula library: " + path);
+	}
+}
+std::vector<CompiledExpression> TFormulaLibrary::load(const std::string& path) {
+	std::ifstream in(path, std::ios::binary | std::ios::ate);
+	if (!in) {
+		throw std::runtime_error("Cannot open formula library: " + path);
+	}
+	std::vector<unsigned char> data(static_cast<size_t>(in.tellg()));
+	in.seekg(0);
+	in.read(reinterpret_cast<char*>(data.data()), data.size());
+	if (!in) {
+		throw std::runtime_error("Cannot read formula library: " + path);
+	}
+	return deserialize(data.data(), data.size());
+}
@@ -0,0 +1,132 @@
+//      
+#include "pool.h"
+namespace {
+thread_local const TTaskPool* workerPool = nullptr;
+thread_local size_t workerIndex = 0;
+}
+TTaskPool::TTaskPool(size_t threads) : queued(0), next(0), stopping(false) {
+	for (size_t i = 0; i < threads; i++) {
+		queues.push_back(std::unique_ptr<TQueue>(new TQueue()));
+	}
+	for (size_t i = 0; i < threads; i++) {
+		workers.emplace_back(&TTaskPool::work, this, i);
+	}
+}
+TTaskPool::~TTaskPool() {
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		stopping = true;
+	}
+	wakeup.notify_all();
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+}
+size_t TTaskPool::GetThreadCount() const {
+	return workers.size();
+}
+size_t TTaskPool::currentQueue() const {
+	return workerPool == this ? workerIndex : queues.size();
+}
+void TTaskPool::submit(std::function<void()> task) {
+	if (queues.empty()) {
+		task();
+		return;
+	}
+	size_t index = currentQueue();
+	if (index == queues.size()) {
+		index = next++ % queues.size();
+	}
+	{
+		std::lock_guard<std::mutex> lock(queues[index]->mutex);
+		queues[index]->tasks.push_back(std::move(task));
+	}
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		queued++;
+	}
+	wakeup.notify_one();
+}
+bool TTaskPool::take(size_t index, std::function<void()>& task) {
+	if (index < queues.size()) {
+		TQueue& own = *queues[index];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (!own.tasks.empty()) {
+			task = std::move(own.tasks.back());
+			own.tasks.pop_back();
+			queued--;
+			return true;
+		}
+	}
+	for (size_t i = 1; i <= queues.size(); i++) {
+		TQueue& victim = *queues[(index + i) % queues.size()];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.tasks.empty()) {
+			task = std::move(victim.tasks.front());
+			victim.tasks.pop_front();
+			queued--;
+			return true;
+		}
+	}
+	return false;
+}
+bool TTaskPool::runPending() {
+	std::function<void()> task;
+	if (queued == 0 || !take(currentQueue(), task)) {
+		return false;
+	}
+	task();
+	return true;
+}
+void TTaskPool::work(size_t index) {
+	workerPool = this;
+	workerIndex = index;
+	while (true) {
+		std::function<void()> task;
+		if (take(index, task)) {
+			task();
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		wakeup.wait(lock, [this] {
+			return stopping || queued > 0;
+		});
+		if (stopping && queued == 0) {
+			return;
+		}
+	}
+}
+TTaskGroup::TTaskGroup(TTaskPool& taskPool) : pool(taskPool), remaining(0) {}
+TTaskGroup::~TTaskGroup() {
+	finish();
+}
+void TTaskGroup::spawn(std::function<void()> task) {
+	remaining++;
+	pool.submit([this, task] {
+		try {
+			task();
+		}
+		catch (...) {
+			std::lock_guard<std::mutex> lock(mutex);
+			if (!failure) {
+				failure = std::current_exception();
+			}
+		}
+		remaining--;
+	});
+}
+void TTaskGroup::finish() {
+	while (remaining > 0) {
+		if (!pool.runPending()) {
+			std::this_thread::yield();
+		}
+	}
+}
+void TTaskGroup::wait() {
+	finish();
+	if (failure) {
+		std::exception_ptr rethrown = failure;
+		failure = nullptr;
+		std::rethrow_exception(rethrown);
+	}
+}
@@ -0,0 +1,123 @@
+//    
+#include "scanner.h"
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SCANNER_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SCANNER_SSE2 1
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+namespace {
+const uint32_t SCANNER_MASK = SCANNER_BLOCK == 32 ? 0xFFFFFFFFu : (1u << (SCANNER_BLOCK % 32)) - 1;
+int lowestBit(uint32_t mask) {
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return static_cast<int>(index);
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+bool isSpaceChar(char c) {
+	return c == ' ' || (c >= '\t' && c <= '\r');
+}
+TCharClasses classifyScalar(const char* p, size_t n) {
+	TCharClasses classes = { 0, 0, 0, 0, 0, 0 };
+	for (size_t i = 0; i < n; i++) {
+		char c = p[i];
+		uint32_t bit = 1u << i;
+		if (isSpaceChar(c)) classes.space |= bit;
+		else if (c >= '0' && c <= '9') classes.digit |= bit;
+		else if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_') classes.identifier |= bit;
+		else if (c == '+' || c == '-' || c == '*' || c == '/' || c == '^' || (c >= '<' && c <= '?') ||
+			c == '!' || c == '&' || c == '|' || c == ':') classes.op |= bit;
+		else if (c == '(' || c == ')') classes.bracket |= bit;
+		else if (c == ',') classes.separator |= bit;
+	}
+	return classes;
+}
+#if defined(SCANNER_AVX2)
+typedef __m256i TVector;
+inline TVector loadBlock(const char* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+inline TVector splat(char c) { return _mm256_set1_epi8(c); }
+inline TVector equal(TVector a, TVector b) { return _mm256_cmpeq_epi8(a, b); }
+inline TVector greater(TVector a, TVector b) { return _mm256_cmpgt_epi8(a, b); }
+inline TVector both(TVector a, TVector b) { return _mm256_and_si256(a, b); }
+inline TVector either(TVector a, TVector b) { return _mm256_or_si256(a, b); }
+inline uint32_t bits(TVector a) { return static_cast<uint32_t>(_mm256_movemask_epi8(a)); }
+#elif defined(SCANNER_SSE2)
+typedef __m128i TVector;
+inline TVector loadBlock(const char* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+inline TVector splat(char c) { return _mm_set1_epi8(c); }
+inline TVector equal(TVector a, TVector b) { return _mm_cmpeq_epi8(a, b); }
+inline TVector greater(TVector a, TVector b) { return _mm_cmpgt_epi8(a, b); }
+inline TVector both(TVector a, TVector b) { return _mm_and_si128(a, b); }
+inline TVector either(TVector a, TVector b) { return _mm_or_si128(a, b); }
+inline uint32_t bits(TVector a) { return static_cast<uint32_t>(_mm_movemask_epi8(a)); }
+#endif
+#if defined(SCANNER_AVX2) || defined(SCANNER_SSE2)
+inline TVector inRange(TVector x, char low, char high) {
+	return both(greater(x, splat(low - 1)), greater(splat(high + 1), x));
+}
+TCharClasses classifyVector(const char* p) {
+	TVector x = loadBlock(p);
+	TVector lower = either(x, splat(0x20));
+	TCharClasses classes;
+	classes.space = bits(either(equal(x, splat(' ')), inRange(x, '\t', '\r')));
+	classes.digit = bits(inRange(x, '0', '9'));
+	classes.identifier = bits(either(inRange(lower, 'a', 'z'), equal(x, splat('_'))));
+	TVector arithmetic = either(either(equal(x, splat('+')), equal(x, splat('-'))),
+		either(either(equal(x, splat('*')), equal(x, splat('/'))), equal(x, splat('^'))));
+	TVector logical = either(either(inRange(x, '<', '?'), equal(x, splat('!'))),
+		either(either(equal(x, splat('&')), equal(x, splat('|'))), equal(x, splat(':'))));
+	classes.op = bits(either(arithmetic, logical));
+	classes.bracket = bits(either(equal(x, splat('(')), equal(x, splat(')'))));
+	classes.separator = bits(equal(x, splat(',')));
+	return classes;
+}
+#endif
+}
+uint32_t TCharClasses::delimiter() const {
+	return space | op | bracket | separator;
+}
+TCharClasses classifyChars(const char* p, size_t n) {
+#if defined(SCANNER_AVX2) || defined(SCANNER_SSE2)
+	if (n >= SCANNER_BLOCK) {
+		return classifyVector(p);
+	}
+#endif
+	return classifyScalar(p, n < SCANNER_BLOCK ? n : SCANNER_BLOCK);
+}
+const char* skipSpaces(const char* p, const char* end) {
+	while (end - p >= static_cast<ptrdiff_t>(SCANNER_BLOCK)) {
+		uint32_t rest = ~classifyChars(p, SCANNER_BLOCK).space & SCANNER_MASK;
+		if (rest != 0) {
+			return p + lowestBit(rest);
+		}
+		p += SCANNER_BLOCK;
+	}
+	while (p < end && isSpaceChar(*p)) {
+		p++;
+	}
+	return p;
+}
+const char* findDelimiter(const char* p, const char* end) {
+	while (end - p >= static_cast<ptrdiff_t>(SCANNER_BLOCK)) {
+		uint32_t found = classifyChars(p, SCANNER_BLOCK).delimiter();
+		if (found != 0) {
+			return p + lowestBit(found);
+		}
+		p += SCANNER_BLOCK;
+	}
+	while (p < end) {
+		TCharClasses classes = classifyScalar(p, 1);
+		if (classes.delimiter() != 0) {
+			return p;
+		}
+		p++;
+	}
+	return p;
+}
@@ -0,0 +1,95 @@
+//       
+#include "tokens.h"
+size_t TokenBuffer::size() const {
+	return kinds.size();
+}
+bool TokenBuffer::empty() const {
+	return kinds.empty();
+}
+void TokenBuffer::clear() {
+	kinds.clear();
+	operators.clear();
+	precedences.clear();
+	offsets.clear();
+	lengths.clear();
+	values.clear();
+	constants.clear();
+}
+void TokenBuffer::reserve(size_t count) {
+	kinds.reserve(count);
+	operators.reserve(count);
+	precedences.reserve(count);
+	offsets.reserve(count);
+	lengths.reserve(count);
+	values.reserve(count);
+}
+void TokenBuffer::push(TokenKind kind, unsigned char op, unsigned char precedence, size_t offset, size_t length) {
+	kinds.push_back(kind);
+	operators.push_back(op);
+	precedences.push_back(precedence);
+	offsets.push_back(static_cast<uint32_t>(offset));
+	lengths.push_back(static_cast<uint32_t>(length));
+	values.push_back(0);
+}
+void TokenBuffer::pushNumber(double value, size_t offset, size_t length) {
+	push(TOKEN_NUMBER, 0, 0, offset, length);
+	values.back() = static_cast<uint32_t>(constants.size());
+	constants.push_back(value);
+}
+void TokenBuffer::pop() {
+	if (kinds.back() == TOKEN_NUMBER) {
+		constants.pop_back();
+	}
+	kinds.pop_back();
+	operators.pop_back();
+	precedences.pop_back();
+	offsets.pop_back();
+	lengths.pop_back();
+	values.pop_back();
+}
+//   [first, last)  window,   
+void TokenBuffer::replace(size_t first, size_t last, const TokenBuffer& window) {
+	size_t constant = constants.size();
+	size_t removed = 0;
+	for (size_t i = first; i < kinds.size(); i++) {
+		if (kinds[i] == TOKEN_NUMBER) {
+			if (constant == constants.size()) {
+				constant = values[i];
+			}
+			if (i >= last) {
+				break;
+			}
+			removed++;
+		}
+	}
+	long long delta = static_cast<long long>(window.constants.size()) - static_cast<long long>(removed);
+	for (size_t i = last; i < kinds.size(); i++) {
+		if (kinds[i] == TOKEN_NUMBER) {
+			values[i] = static_cast<uint32_t>(values[i] + delta);
+		}
+	}
+	constants.erase(constants.begin() + constant, constants.begin() + constant + removed);
+	constants.insert(constants.begin() + constant, window.constants.begin(), window.constants.end());
+	kinds.erase(kinds.begin() + first, kinds.begin() + last);
+	kinds.insert(kinds.begin() + first, window.kinds.begin(), window.kinds.end());
+	operators.erase(operators.begin() + first, operators.begin() + last);
+	operators.insert(operators.begin() + first, window.operators.begin(), window.operators.end());
+	precedences.erase(precedences.begin() + first, precedences.begin() + last);
+	precedences.insert(precedences.begin() + first, window.precedences.begin(), window.precedences.end());
+	offsets.erase(offsets.begin() + first, offsets.begin() + last);
+	offsets.insert(offsets.begin() + first, window.offsets.begin(), window.offsets.end());
+	lengths.erase(lengths.begin() + first, lengths.begin() + last);
+	lengths.insert(lengths.begin() + first, window.lengths.begin(), window.lengths.end());
+	values.erase(values.begin() + first, values.begin() + last);
+	values.insert(values.begin() + first, window.values.begin(), window.values.end());
+	for (size_t i = first; i < first + window.size(); i++) {
+		if (kinds[i] == TOKEN_NUMBER) {
+			values[i] = static_cast<uint32_t>(values[i] + constant);
+		}
+	}
+}
+void TokenBuffer::shift(size_t first, long long delta) {
+	for (size_t i = first; i < offsets.size(); i++) {
+		offsets[i] = static_cast<uint32_t>(offsets[i] + delta);
+	}
+}
@@ -0,0 +1,268 @@
+//    
+#include "vecmath.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define VECMATH_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VECMATH_SSE2 1
+#endif
+namespace {
+const double ROUND_MAGIC = 6755399441055744.0;
+const double EXPONENT_MAGIC = 4503599627370496.0;
+const double LOG2E = 1.44269504088896338700e+00;
+const double LN2_HI = 6.93147180369123816490e-01;
+const double LN2_LO = 1.90821492927058770002e-10;
+const double SQRT2 = 1.41421356237309514547e+00;
+const double TWO_OVER_PI = 6.36619772367581382433e-01;
+const double PIO2_1 = 1.57079632673412561417e+00;
+const double PIO2_2 = 6.07710050630396597660e-11;
+const double PIO2_3 = 2.02226624871116645580e-21;
+struct TScalarLanes {
+	typedef double type;
+	static const size_t WIDTH = 1;
+	static uint64_t bits(double a) {
+		uint64_t result;
+		std::memcpy(&result, &a, sizeof(result));
+		return result;
+	}
+	static double value(uint64_t a) {
+		double result;
+		std::memcpy(&result, &a, sizeof(result));
+		return result;
+	}
+	static double load(const double* p) { return *p; }
+	static void store(double* p, double a) { *p = a; }
+	static double splat(double a) { return a; }
+	static double add(double a, double b) { return a + b; }
+	static double sub(double a, double b) { return a - b; }
+	static double mul(double a, double b) { return a * b; }
+	static double div(double a, double b) { return a / b; }
+	static double sqrt(double a) { return std::sqrt(a); }
+	static double mask(bool condition) { return value(condition ? ~0ull : 0ull); }
+	static double less(double a, double b) { return mask(a < b); }
+	static double greater(double a, double b) { return mask(a > b); }
+	static double equal(double a, double b) { return mask(a == b); }
+	static double isNaN(double a) { return mask(a != a); }
+	static double either(double a, double b) { return value(bits(a) | bits(b)); }
+	static double select(double m, double a, double b) { return value((bits(m) & bits(a)) | (~bits(m) & bits(b))); }
+	static double andBits(double a, uint64_t m) { return value(bits(a) & m); }
+	static double orBits(double a, uint64_t m) { return value(bits(a) | m); }
+	static double xorBits(double a, uint64_t m) { return value(bits(a) ^ m); }
+	static double addBits(double a, uint64_t c) { return value(bits(a) + c); }
+	static double shiftLeft(double a, int n) { return value(bits(a) << n); }
+	static double shiftRight(double a, int n) { return value(bits(a) >> n); }
+};
+#if defined(VECMATH_AVX2)
+struct TSimdLanes {
+	typedef __m256d type;
+	static const size_t WIDTH = 4;
+	static __m256i asInt(__m256d a) { return _mm256_castpd_si256(a); }
+	static __m256d asDouble(__m256i a) { return _mm256_castsi256_pd(a); }
+	static __m256d load(const double* p) { return _mm256_loadu_pd(p); }
+	static void store(double* p, __m256d a) { _mm256_storeu_pd(p, a); }
+	static __m256d splat(double a) { return _mm256_set1_pd(a); }
+	static __m256d add(__m256d a, __m256d b) { return _mm256_add_pd(a, b); }
+	static __m256d sub(__m256d a, __m256d b) { return _mm256_sub_pd(a, b); }
+	static __m256d mul(__m256d a, __m256d b) { return _mm256_mul_pd(a, b); }
+	static __m256d div(__m256d a, __m256d b) { return _mm256_div_pd(a, b); }
+	static __m256d sqrt(__m256d a) { return _mm256_sqrt_pd(a); }
+	static __m256d less(__m256d a, __m256d b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+	static __m256d greater(__m256d a, __m256d b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+	static __m256d equal(__m256d a, __m256d b) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+	static __m256d isNaN(__m256d a) { return _mm256_cmp_pd(a, a, _CMP_UNORD_Q); }
+	static __m256d either(__m256d a, __m256d b) { return _mm256_or_pd(a, b); }
+	static __m256d select(__m256d m, __m256d a, __m256d b) { return _mm256_blendv_pd(b, a, m); }
+	static __m256d andBits(__m256d a, uint64_t m) { return _mm256_and_pd(a, asDouble(_mm256_set1_epi64x(static_cast<long long>(m)))); }
+	static __m256d orBits(__m256d a, uint64_t m) { return _mm256_or_pd(a, asDouble(_mm256_set1_epi64x(static_cast<long long>(m)))); }
+	static __m256d xorBits(__m256d a, uint64_t m) { return _mm256_xor_pd(a, asDouble(_mm256_set1_epi64x(static_cast<long long>(m)))); }
+	static __m256d addBits(__m256d a, uint64_t c) { return asDouble(_mm256_add_epi64(asInt(a), _mm256_set1_epi64x(static_cast<long long>(c)))); }
+	static __m256d shiftLeft(__m256d a, int n) { return asDouble(_mm256_sll_epi64(asInt(a), _mm_cvtsi32_si128(n))); }
+	static __m256d shiftRight(__m256d a, int n) { return asDouble(_mm256_srl_epi64(asInt(a), _mm_cvtsi32_si128(n))); }
+};
+#elif defined(VECMATH_SSE2)
+struct TSimdLanes {
+	typedef __m128d type;
+	static const size_t WIDTH = 2;
+	static __m128i asInt(__m128d a) { return _mm_castpd_si128(a); }
+	static __m128d asDouble(__m128i a) { return _mm_castsi128_pd(a); }
+	static __m128d load(const double* p) { return _mm_loadu_pd(p); }
+	static void store(double* p, __m128d a) { _mm_storeu_pd(p, a); }
+	static __m128d splat(double a) { return _mm_set1_pd(a); }
+	static __m128d add(__m128d a, __m128d b) { return _mm_add_pd(a, b); }
+	static __m128d sub(__m128d a, __m128d b) { return _mm_sub_pd(a, b); }
+	static __m128d mul(__m128d a, __m128d b) { return _mm_mul_pd(a, b); }
+	static __m128d div(__m128d a, __m128d b) { return _mm_div_pd(a, b); }
+	static __m128d sqrt(__m128d a) { return _mm_sqrt_pd(a); }
+	static __m128d less(__m128d a, __m128d b) { return _mm_cmplt_pd(a, b); }
+	static __m128d greater(__m128d a, __m128d b) { return _mm_cmpgt_pd(a, b); }
+	static __m128d equal(__m128d a, __m128d b) { return _mm_cmpeq_pd(a, b); }
+	static __m128d isNaN(__m128d a) { return _mm_cmpunord_pd(a, a); }
+	static __m128d either(__m128d a, __m128d b) { return _mm_or_pd(a, b); }
+	static __m128d select(__m128d m, __m128d a, __m128d b) { return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b)); }
+	static __m128d andBits(__m128d a, uint64_t m) { return _mm_and_pd(a, asDouble(_mm_set1_epi64x(static_cast<long long>(m)))); }
+	static __m128d orBits(__m128d a, uint64_t m) { return _mm_or_pd(a, asDouble(_mm_set1_epi64x(static_cast<long long>(m)))); }
+	static __m128d xorBits(__m128d a, uint64_t m) { return _mm_xor_pd(a, asDouble(_mm_set1_epi64x(static_cast<long long>(m)))); }
+	static __m128d addBits(__m128d a, uint64_t c) { return asDouble(_mm_add_epi64(asInt(a), _mm_set1_epi64x(static_cast<long long>(c)))); }
+	static __m128d shiftLeft(__m128d a, int n) { return asDouble(_mm_sll_epi64(asInt(a), _mm_cvtsi32_si128(n))); }
+	static __m128d shiftRight(__m128d a, int n) { return asDouble(_mm_srl_epi64(asInt(a), _mm_cvtsi32_si128(n))); }
+};
+#else
+typedef TScalarLanes TSimdLanes;
+#endif
+template<typename L>
+typename L::type roundToInteger(typename L::type a) {
+	return L::sub(L::add(a, L::splat(ROUND_MAGIC)), L::splat(ROUND_MAGIC));
+}
+template<typename L>
+typename L::type floorOfHalf(typename L::type k) {
+	return roundToInteger<L>(L::sub(L::mul(k, L::splat(0.5)), L::splat(0.25)));
+}
+template<typename L>
+typename L::type powerOfTwo(typename L::type k) {
+	return L::shiftLeft(L::addBits(L::add(k, L::splat(ROUND_MAGIC)), 1023), 52);
+}
+template<typename L>
+typename L::type mulAdd(typename L::type a, typename L::type b, double c) {
+	return L::add(L::mul(a, b), L::splat(c));
+}
+template<typename L>
+typename L::type expKernel(typename L::type x) {
+	typename L::type c = L::select(L::less(x, L::splat(-746.0)), L::splat(-746.0), x);
+	c = L::select(L::greater(c, L::splat(710.0)), L::splat(710.0), c);
+	typename L::type k = roundToInteger<L>(L::mul(c, L::splat(LOG2E)));
+	typename L::type r = L::sub(L::sub(c, L::mul(k, L::splat(LN2_HI))), L::mul(k, L::splat(LN2_LO)));
+	typename L::type p = mulAdd<L>(L::splat(1.0 / 6227020800.0), r, 1.0 / 479001600.0);
+	p = mulAdd<L>(p, r, 1.0 / 39916800.0);
+	p = mulAdd<L>(p, r, 1.0 / 3628800.0);
+	p = mulAdd<L>(p, r, 1.0 / 362880.0);
+	p = mulAdd<L>(p, r, 1.0 / 40320.0);
+	p = mulAdd<L>(p, r, 1.0 / 5040.0);
+	p = mulAdd<L>(p, r, 1.0 / 720.0);
+	p = mulAdd<L>(p, r, 1.0 / 120.0);
+	p = mulAdd<L>(p, r, 1.0 / 24.0);
+	p = mulAdd<L>(p, r, 1.0 / 6.0);
+	p = mulAdd<L>(p, r, 0.5);
+	p = L::add(L::splat(1.0), L::add(r, L::mul(L::mul(r, r), p)));
+	typename L::type k1 = floorOfHalf<L>(k);
+	typename L::type k2 = L::sub(k, k1);
+	return L::mul(L::mul(p, powerOfTwo<L>(k1)), powerOfTwo<L>(k2));
+}
+template<typename L>
+typename L::type logKernel(typename L::type x) {
+	typename L::type subnormal = L::less(x, L::splat(std::numeric_limits<double>::min()));
+	typename L::type scaled = L::select(subnormal, L::mul(x, L::splat(18014398509481984.0)), x);
+	typename L::type biased = L::sub(L::orBits(L::andBits(L::shiftRight(scaled, 52), 0x7FF), 0x4330000000000000ull), L::splat(EXPONENT_MAGIC));
+	typename L::type k = L::sub(biased, L::select(subnormal, L::splat(1023.0 + 54.0), L::splat(1023.0)));
+	typename L::type m = L::orBits(L::andBits(scaled, 0x000FFFFFFFFFFFFFull), 0x3FF0000000000000ull);
+	typename L::type high = L::greater(m, L::splat(SQRT2));
+	m = L::select(high, L::mul(m, L::splat(0.5)), m);
+	k = L::select(high, L::add(k, L::splat(1.0)), k);
+	typename L::type f = L::sub(m, L::splat(1.0));
+	typename L::type s = L::div(f, L::add(L::splat(2.0), f));
+	typename L::type z = L::mul(s, s);
+	typename L::type w = L::mul(z, z);
+	typename L::type odd = mulAdd<L>(mulAdd<L>(mulAdd<L>(L::splat(1.479819860511658591e-01), w, 1.818357216161805012e-01), w, 2.857142874366239149e-01), w, 6.666666666666735130e-01);
+	typename L::type even = mulAdd<L>(mulAdd<L>(L::splat(1.531383769920937332e-01), w, 2.222219843214978396e-01), w, 3.999999999940941908e-01);
+	typename L::type R = L::add(L::mul(z, odd), L::mul(w, even));
+	typename L::type hfsq = L::mul(L::mul(L::splat(0.5), f), f);
+	typename L::type tail = L::add(L::mul(s, L::add(hfsq, R)), L::mul(k, L::splat(LN2_LO)));
+	typename L::type result = L::sub(L::mul(k, L::splat(LN2_HI)), L::sub(L::sub(hfsq, tail), f));
+	typename L::type infinity = L::splat(std::numeric_limits<double>::infinity());
+	result = L::select(L::equal(x, infinity), infinity, result);
+	result = L::select(L::equal(x, L::splat(0.0)), L::splat(-std::numeric_limits<double>::infinity()), result);
+	return L::select(L::either(L::less(x, L::splat(0.0)), L::isNaN(x)), L::splat(std::numeric_limits<double>::quiet_NaN()), result);
+}
+template<typename L>
+typename L::type sinCosKernel(typename L::type x, bool cosine) {
+	const uint64_t SIGN = 0x8000000000000000ull;
+	typename L::type k = roundToInteger<L>(L::mul(x, L::splat(TWO_OVER_PI)));
+	typename L::type r = L::sub(L::sub(L::sub(x, L::mul(k, L::splat(PIO2_1))), L::mul(k, L::splat(PIO2_2))), L::mul(k, L::splat(PIO2_3)));
+	typename L::type z = L::mul(r, r);
+	typename L::type ps = mulAdd<L>(L::splat(1.58969099521155010221e-10), z, -2.50507602534068634195e-08);
+	ps = mulAdd<L>(ps, z, 2.75573137070700676789e-06);
+	ps = mulAdd<L>(ps, z, -1.98412698298579493134e-04);
+	ps = mulAdd<L>(ps, z, 8.33333333332248946124e-03);
+	ps = mulAdd<L>(ps, z, -1.66666666666666324348e-01);
+	typename L::type pc = mulAdd<L>(L::splat(-1.13596475577881948265e-11), z, 2.08757232129817482790e-09);
+	pc = mulAdd<L>(pc, z, -2.75573143513906633035e-07);
+	pc = mulAdd<L>(pc, z, 2.48015872894767294178e-05);
+	pc = mulAdd<L>(pc, z, -1.38888888888741095749e-03);
+	pc = mulAdd<L>(pc, z, 4.16666666666666019037e-02);
+	typename L::type s = L::add(r, L::mul(L::mul(r, z), ps));
+	typename L::type hz = L::mul(L::splat(0.5), z);
+	typename L::type w = L::sub(L::splat(1.0), hz);
+	typename L::type c = L::add(w, L::add(L::sub(L::sub(L::splat(1.0), w), hz), L::mul(L::mul(z, z), pc)));
+	typename L::type half = floorOfHalf<L>(k);
+	typename L::type odd = L::greater(L::sub(L::mul(k, L::splat(0.5)), half), L::splat(0.25));
+	typename L::type flip = L::greater(L::sub(L::mul(half, L::splat(0.5)), floorOfHalf<L>(half)), L::splat(0.25));
+	typename L::type base = cosine ? L::select(odd, L::xorBits(s, SIGN), c) : L::select(odd, c, s);
+	return L::select(flip, L::xorBits(base, SIGN), base);
+}
+struct TExpKernel {
+	template<typename L> typename L::type apply(typename L::type x) const { return expKernel<L>(x); }
+};
+struct TLogKernel {
+	template<typename L> typename L::type apply(typename L::type x) const { return logKernel<L>(x); }
+};
+struct TSinKernel {
+	template<typename L> typename L::type apply(typename L::type x) const { return sinCosKernel<L>(x, false); }
+};
+struct TCosKernel {
+	template<typename L> typename L::type apply(typename L::type x) const { return sinCosKernel<L>(x, true); }
+};
+struct TSqrtKernel {
+	template<typename L> typename L::type apply(typename L::type x) const { return L::sqrt(x); }
+};
+struct TAbsKernel {
+	template<typename L> typename L::type apply(typename L::type x) const { return L::andBits(x, 0x7FFFFFFFFFFFFFFFull); }
+};
+template<typename K>
+void applyBlock(const double* x, size_t n, double* out, const K& kernel) {
+	size_t i = 0;
+	for (; i + TSimdLanes::WIDTH <= n; i += TSimdLanes::WIDTH) {
+		TSimdLanes::store(out + i, kernel.template apply<TSimdLanes>(TSimdLanes::load(x + i)));
+	}
+	for (; i < n; i++) {
+		out[i] = kernel.template apply<TScalarLanes>(x[i]);
+	}
+}
+bool trigInRange(const double* x, size_t n) {
+	for (size_t i = 0; i < n; i++) {
+		if (std::fabs(x[i]) > VECMATH_TRIG_LIMIT) {
+			return false;
+		}
+	}
+	return true;
+}
+}
+void expBlock(const double* x, size_t n, double* out) {
+	applyBlock(x, n, out, TExpKernel());
+}
+void logBlock(const double* x, size_t n, double* out) {
+	applyBlock(x, n, out, TLogKernel());
+}
+void sinBlock(const double* x, size_t n, double* out) {
+	if (!trigInRange(x, n)) {
+		for (size_t i = 0; i < n; i++) out[i] = std::sin(x[i]);
+		return;
+	}
+	applyBlock(x, n, out, TSinKernel());
+}
+void cosBlock(const double* x, size_t n, double* out) {
+	if (!trigInRange(x, n)) {
+		for (size_t i = 0; i < n; i++) out[i] = std::cos(x[i]);
+		return;
+	}
+	applyBlock(x, n, out, TCosKernel());
+}
+void sqrtBlock(const double* x, size_t n, double* out) {
+	applyBlock(x, n, out, TSqrtKernel());
+}
+void absBlock(const double* x, size_t n, double* out) {
+	applyBlock(x, n, out, TAbsKernel());
+}
@@ -300,4 +300,626 @@ TEST(TPostfix, test_multiple_expressions_with_same_object) {
 	postfix.setInfix("a * b - c");
 	postfix.SetVariable("c", 1);
 	EXPECT_DOUBLE_EQ(postfix.calculate(), 5.0); 
-}
\ No newline at end of file
+}
+TEST(TPostfix, test_tokenize_stores_parsed_value_of_number) {
+	TPostfix postfix("25.5 + 3");
+	auto tokens = postfix.tokenize();
+	EXPECT_DOUBLE_EQ(tokens[0].number, 25.5);
+	EXPECT_DOUBLE_EQ(tokens[2].number, 3.0);
+}
+TEST(TPostfix, test_tokenize_reads_exponent_notation_as_single_number) {
+	TPostfix postfix("1e-9 + 2.5E3");
+	auto tokens = postfix.tokenize();
+	ASSERT_EQ(tokens.size(), 3);
+	EXPECT_EQ(tokens[0].type, "number");
+	EXPECT_EQ(tokens[0].value, "1e-9");
+	EXPECT_EQ(tokens[2].type, "number");
+}
+TEST(TPostfix, test_calculate_handles_exponent_notation) {
+	TPostfix postfix("2e3 * 1e-3 - -1.5e0");
+	EXPECT_DOUBLE_EQ(postfix.calculate(), 3.5);
+}
+TEST(TPostfix, test_tokenize_splits_operators_without_spaces) {
+	TPostfix postfix("a-b*2");
+	postfix.SetVariable("a", 10);
+	postfix.SetVariable("b", 3);
+	EXPECT_DOUBLE_EQ(postfix.calculate(), 4.0);
+}
+TEST(TPostfix, test_validate_throws_for_number_followed_by_letters) {
+	TPostfix postfix("2x + 1");
+	EXPECT_THROW(postfix.validate(), std::invalid_argument);
+}
+TEST(TPostfix, test_tokenize_handles_long_variable_names_and_spaces) {
+	std::string name(50, 'v');
+	TPostfix postfix(name + std::string(40, ' ') + "+ 1");
+	postfix.SetVariable(name, 2);
+	EXPECT_DOUBLE_EQ(postfix.calculate(), 3.0);
+}
+TEST(TPostfix, test_getPostfixOrder_references_tokens_in_postfix_order) {
+	TPostfix postfix("(a + b) * c");
+	std::vector<int> order = postfix.GetPostfixOrder();
+	auto tokens = postfix.GetTokens();
+	std::string joined;
+	for (int index : order) {
+		joined += tokens[index].value;
+	}
+	EXPECT_EQ(joined, "ab+c*");
+}
+TEST(TPostfix, test_getPostfix_has_no_trailing_space_for_long_expression) {
+	std::string expression = "1";
+	for (int i = 0; i < 1000; i++) {
+		expression += " + 1";
+	}
+	TPostfix postfix(expression);
+	std::string result = postfix.GetPostfix();
+	EXPECT_NE(result.back(), ' ');
+	EXPECT_DOUBLE_EQ(postfix.calculate(), 1001.0);
+}
+TEST(TPostfix, test_calculate_builtin_functions) {
+	TPostfix postfix("sqrt(x) + abs(-3) * exp(0) - log(1) + sin(0) + cos(0)");
+	postfix.SetVariable("x", 16);
+	EXPECT_DOUBLE_EQ(postfix.calculate(), 8.0);
+}
+TEST(TPostfix, test_calculate_variadic_min_max) {
+	TPostfix postfix("max(1, a, 2 * a, -4) - min(a ^ 2, 3, (a + 1))");
+	postfix.SetVariable("a", 2);
+	EXPECT_DOUBLE_EQ(postfix.calculate(), 1.0);
+}
+TEST(TPostfix, test_function_postfix_follows_arguments) {
+	TPostfix postfix("min(a + b, c)");
+	EXPECT_EQ(postfix.GetPostfix(), "a b + c min");
+}
+TEST(TPostfix, test_nested_function_calls) {
+	TPostfix postfix("max(abs(x - 5), sqrt(min(x, 9)))");
+	postfix.SetVariable("x", 1);
+	EXPECT_DOUBLE_EQ(postfix.calculate(), 4.0);
+}
+TEST(TPostfix, test_function_name_without_call_is_variable) {
+	TPostfix postfix("sin + 1");
+	postfix.SetVariable("sin", 2);
+	EXPECT_DOUBLE_EQ(postfix.calculate(), 3.0);
+}
+TEST(TPostfix, test_validate_wrong_function_arity) {
+	TPostfix postfix("sin(1, 2)");
+	EXPECT_THROW(postfix.validate(), std::invalid_argument);
+	postfix.setInfix("sqrt()");
+	EXPECT_THROW(postfix.validate(), std::invalid_argument);
+	postfix.setInfix("max()");
+	EXPECT_THROW(postfix.validate(), std::invalid_argument);
+}
+TEST(TPostfix, test_validate_misplaced_separator) {
+	TPostfix postfix("1, 2");
+	EXPECT_THROW(postfix.validate(), std::invalid_argument);
+	postfix.setInfix("(1, 2)");
+	EXPECT_THROW(postfix.validate(), std::invalid_argument);
+	postfix.setInfix("min(1, )");
+	EXPECT_THROW(postfix.validate(), std::invalid_argument);
+	postfix.setInfix("min(, 1)");
+	EXPECT_THROW(postfix.validate(), std::invalid_argument);
+	postfix.setInfix("2 sin(1)");
+	EXPECT_THROW(postfix.validate(), std::invalid_argument);
+}
+TEST(TPostfix, test_tokenize_multichar_operators) {
+	TPostfix postfix("a>=b&&c!=d||!e");
+	auto tokens = postfix.tokenize();
+	std::vector<std::string> values;
+	for (const Token& token : tokens) {
+		values.push_back(token.value);
+	}
+	std::vector<std::string> expected = { "a", ">=", "b", "&&", "c", "!=", "d", "||", "!", "e" };
+	EXPECT_EQ(values, expected);
+}
+TEST(TPostfix, test_calculate_comparisons) {
+	TPostfix postfix("(a < b) + (a <= a) * 2 + (a > b) * 4 + (b >= a) * 8 + (a == 1) * 16 + (a != 1) * 32");
+	postfix.SetVariable("a", 1);
+	postfix.SetVariable("b", 2);
+	EXPECT_DOUBLE_EQ(postfix.calculate(), 27.0);
+}
+TEST(TPostfix, test_logical_operators_priority) {
+	TPostfix postfix("a + 1 > b && c < d || !e");
+	EXPECT_EQ(postfix.GetPostfix(), "a 1 + b > c d < && e ! ||");
+	postfix.SetVariable("a", 1);
+	postfix.SetVariable("b", 3);
+	postfix.SetVariable("c", 0);
+	postfix.SetVariable("d", 1);
+	postfix.SetVariable("e", 0);
+	EXPECT_DOUBLE_EQ(postfix.calculate(), 1.0);
+	postfix.SetVariable("e", 5);
+	EXPECT_DOUBLE_EQ(postfix.calculate(), 0.0);
+}
+TEST(TPostfix, test_conditional_is_right_associative) {
+	TPostfix postfix("x > 0 ? 1 : x < 0 ? -1 : 0");
+	EXPECT_EQ(postfix.GetPostfix(), "x 0 > 1 x 0 < -1 0 ?: ?:");
+	postfix.SetVariable("x", 5);
+	EXPECT_DOUBLE_EQ(postfix.calculate(), 1.0);
+	postfix.SetVariable("x", -5);
+	EXPECT_DOUBLE_EQ(postfix.calculate(), -1.0);
+	postfix.SetVariable("x", 0);
+	EXPECT_DOUBLE_EQ(postfix.calculate(), 0.0);
+}
+TEST(TPostfix, test_nested_conditional_in_then_branch) {
+	TPostfix postfix("a ? b ? 1 : 2 : 3");
+	postfix.SetVariable("a", 1);
+	postfix.SetVariable("b", 0);
+	EXPECT_DOUBLE_EQ(postfix.calculate(), 2.0);
+	postfix.SetVariable("a", 0);
+	EXPECT_DOUBLE_EQ(postfix.calculate(), 3.0);
+}
+TEST(TPostfix, test_conditional_inside_function_call) {
+	TPostfix postfix("max(x > 2 ? x : 2, 1) * 2");
+	postfix.SetVariable("x", 5);
+	EXPECT_DOUBLE_EQ(postfix.calculate(), 10.0);
+}
+TEST(TPostfix, test_validate_malformed_conditions) {
+	TPostfix postfix("a ? b");
+	EXPECT_THROW(postfix.validate(), std::invalid_argument);
+	postfix.setInfix("a : b");
+	EXPECT_THROW(postfix.validate(), std::invalid_argument);
+	postfix.setInfix("(a ? b) : c");
+	EXPECT_THROW(postfix.validate(), std::invalid_argument);
+	postfix.setInfix("a = b");
+	EXPECT_THROW(postfix.validate(), std::invalid_argument);
+	postfix.setInfix("a & b");
+	EXPECT_THROW(postfix.validate(), std::invalid_argument);
+	postfix.setInfix("a ! b");
+	EXPECT_THROW(postfix.validate(), std::invalid_argument);
+	postfix.setInfix("a < > b");
+	EXPECT_THROW(postfix.validate(), std::invalid_argument);
+}
+TEST(TPostfix, test_conditional_compiles_to_jumps) {
+	TPostfix postfix("c ? a : b");
+	const CompiledExpression& program = postfix.compile();
+	ASSERT_EQ(program.code.size(), 5);
+	EXPECT_EQ(program.code[1].op, OpCode::JumpIfZero);
+	EXPECT_EQ(program.code[1].arg, 4);
+	EXPECT_EQ(program.code[3].op, OpCode::Jump);
+	EXPECT_EQ(program.code[3].arg, 5);
+}
+TEST(TPostfix, test_conditional_skips_untaken_branch) {
+	int calls = 0;
+	TPostfix postfix("x > 0 ? tick() : 0 - tick()");
+	postfix.registerFunction("tick", 0, [&calls](const double*) {
+		return static_cast<double>(++calls);
+	}, 0);
+	postfix.SetVariable("x", 1);
+	EXPECT_DOUBLE_EQ(postfix.calculate(), 1.0);
+	postfix.SetVariable("x", -1);
+	EXPECT_DOUBLE_EQ(postfix.calculate(), -2.0);
+	EXPECT_EQ(calls, 2);
+}
+TEST(TPostfix, test_logical_operators_short_circuit) {
+	int calls = 0;
+	TPostfix postfix("(x && tick()) + (x || tick()) * 2");
+	postfix.registerFunction("tick", 0, [&calls](const double*) {
+		return static_cast<double>(++calls);
+	}, 0);
+	postfix.SetVariable("x", 0);
+	EXPECT_DOUBLE_EQ(postfix.calculate(), 2.0);
+	EXPECT_EQ(calls, 1);
+	postfix.SetVariable("x", 3);
+	EXPECT_DOUBLE_EQ(postfix.calculate(), 3.0);
+	EXPECT_EQ(calls, 2);
+}
+TEST(TPostfix, test_untaken_division_by_zero_is_not_evaluated) {
+	TPostfix postfix("x != 0 && 1 / x > 1 ? 1 / x : 0");
+	postfix.SetVariable("x", 0);
+	EXPECT_DOUBLE_EQ(postfix.calculate(), 0.0);
+	postfix.SetVariable("x", 0.5);
+	EXPECT_DOUBLE_EQ(postfix.calculate(), 2.0);
+}
+TEST(TPostfix, test_static_compile_returns_program) {
+	auto compiled = TPostfix::compile("a * (b + 2)");
+	ASSERT_TRUE(compiled.hasValue());
+	EXPECT_EQ(compiled->names.size(), 2u);
+	TPostfix postfix;
+	postfix.setProgram(*compiled);
+	postfix.SetVariable("a", 3);
+	postfix.SetVariable("b", 1);
+	EXPECT_DOUBLE_EQ(postfix.calculate(), 9.0);
+}
+TEST(TPostfix, test_static_compile_uses_function_table) {
+	TFunctionTable table;
+	table.add("twice", 1, [](const double* args) {
+		return 2 * args[0];
+	});
+	EXPECT_TRUE(TPostfix::compile("twice(x)", table).hasValue());
+	EXPECT_FALSE(TPostfix::compile("twice(x)").hasValue());
+}
+TEST(TPostfix, test_static_compile_reports_error_span) {
+	auto compiled = TPostfix::compile("1 + * 2");
+	ASSERT_FALSE(compiled.hasValue());
+	EXPECT_EQ(compiled.error().kind, ParseErrorKind::MissingOperand);
+	EXPECT_EQ(compiled.error().offset, 4u);
+	EXPECT_EQ(compiled.error().length, 1u);
+	compiled = TPostfix::compile("x >= 1 ? (2 : 3");
+	ASSERT_FALSE(compiled.hasValue());
+	EXPECT_EQ(compiled.error().kind, ParseErrorKind::UnmatchedCondition);
+	EXPECT_EQ(compiled.error().offset, 12u);
+	compiled = TPostfix::compile("max(1, (2 + 3)");
+	ASSERT_FALSE(compiled.hasValue());
+	EXPECT_EQ(compiled.error().kind, ParseErrorKind::UnmatchedBracket);
+	EXPECT_EQ(compiled.error().offset, 3u);
+	compiled = TPostfix::compile("sin(1, 2) + 1");
+	ASSERT_FALSE(compiled.hasValue());
+	EXPECT_EQ(compiled.error().kind, ParseErrorKind::ArgumentCount);
+	EXPECT_EQ(compiled.error().offset, 0u);
+	EXPECT_EQ(compiled.error().length, 9u);
+	compiled = TPostfix::compile("   ");
+	ASSERT_FALSE(compiled.hasValue());
+	EXPECT_EQ(compiled.error().kind, ParseErrorKind::EmptyExpression);
+}
+TEST(TPostfix, test_throwing_api_reports_same_message) {
+	auto compiled = TPostfix::compile("(a + b");
+	ASSERT_FALSE(compiled.hasValue());
+	TPostfix postfix("(a + b");
+	try {
+		postfix.compile();
+		FAIL() << "Expected std::invalid_argument";
+	}
+	catch (const std::invalid_argument& e) {
+		EXPECT_EQ(std::string(e.what()), compiled.error().message);
+	}
+}
+TEST(TPostfix, test_diagnose_returns_empty_list_for_valid_expression) {
+	TPostfix postfix("max(a, b) * 2");
+	EXPECT_TRUE(postfix.diagnose().empty());
+	EXPECT_EQ(postfix.GetPostfix(), "a b max 2 *");
+}
+TEST(TPostfix, test_diagnose_collects_all_errors) {
+	TPostfix postfix("(1 + * 2)) + (3 4");
+	std::vector<ParseError> errors = postfix.diagnose();
+	ASSERT_EQ(errors.size(), 4u);
+	EXPECT_EQ(errors[0].kind, ParseErrorKind::MissingOperand);
+	EXPECT_EQ(errors[0].offset, 5u);
+	EXPECT_EQ(errors[1].kind, ParseErrorKind::UnmatchedBracket);
+	EXPECT_EQ(errors[1].offset, 9u);
+	EXPECT_EQ(errors[2].kind, ParseErrorKind::MissingOperator);
+	EXPECT_EQ(errors[2].offset, 16u);
+	EXPECT_EQ(errors[3].kind, ParseErrorKind::UnmatchedBracket);
+	EXPECT_EQ(errors[3].offset, 13u);
+}
+TEST(TPostfix, test_diagnose_first_error_matches_validate) {
+	const char* expressions[] = { "1 +", "sin(1, 2)", "a ? b", "1, 2", "f(", "x : y", "((a)" };
+	for (const char* expression : expressions) {
+		TPostfix postfix(expression);
+		std::vector<ParseError> errors = postfix.diagnose();
+		ASSERT_FALSE(errors.empty()) << expression;
+		try {
+			postfix.validate();
+			FAIL() << expression;
+		}
+		catch (const std::invalid_argument& e) {
+			EXPECT_EQ(std::string(e.what()), errors.front().message) << expression;
+		}
+	}
+}
+TEST(TPostfix, test_diagnose_reports_argument_count_and_unclosed_condition) {
+	TPostfix postfix("sin(x, 1) + (a ? b) + min()");
+	std::vector<ParseError> errors = postfix.diagnose();
+	ASSERT_EQ(errors.size(), 3u);
+	EXPECT_EQ(errors[0].kind, ParseErrorKind::ArgumentCount);
+	EXPECT_EQ(errors[0].length, 9u);
+	EXPECT_EQ(errors[1].kind, ParseErrorKind::UnmatchedCondition);
+	EXPECT_EQ(errors[2].kind, ParseErrorKind::ArgumentCount);
+}
+static void expectSameParse(TPostfix& edited, const std::string& expression) {
+	TPostfix full(expression);
+	EXPECT_EQ(edited.GetInfix(), expression);
+	EXPECT_EQ(edited.GetPostfix(), full.GetPostfix()) << expression;
+	std::vector<Token> a = edited.GetTokens();
+	std::vector<Token> b = full.GetTokens();
+	ASSERT_EQ(a.size(), b.size()) << expression;
+	for (size_t i = 0; i < a.size(); i++) {
+		EXPECT_EQ(a[i].value, b[i].value) << expression;
+		EXPECT_EQ(a[i].type, b[i].type) << expression;
+		EXPECT_EQ(a[i].offset, b[i].offset) << expression;
+		EXPECT_EQ(a[i].arity, b[i].arity) << expression;
+	}
+}
+TEST(TPostfix, test_applyEdit_reparses_enclosing_brackets) {
+	TPostfix postfix("a * (b + 2) - max(c, d ^ 2)");
+	postfix.GetPostfix();
+	EXPECT_TRUE(postfix.applyEdit(9, 1, "27"));
+	expectSameParse(postfix, "a * (b + 27) - max(c, d ^ 2)");
+	EXPECT_TRUE(postfix.applyEdit(7, 1, "*"));
+	expectSameParse(postfix, "a * (b * 27) - max(c, d ^ 2)");
+	EXPECT_TRUE(postfix.applyEdit(22, 1, "dd"));
+	expectSameParse(postfix, "a * (b * 27) - max(c, dd ^ 2)");
+	EXPECT_TRUE(postfix.applyEdit(0, 0, "sin"));
+	expectSameParse(postfix, "sina * (b * 27) - max(c, dd ^ 2)");
+	postfix.SetVariable("sina", 1);
+	postfix.SetVariable("b", 2);
+	postfix.SetVariable("c", 3);
+	postfix.SetVariable("dd", 2);
+	EXPECT_DOUBLE_EQ(postfix.calculate(), 50.0);
+}
+TEST(TPostfix, test_applyEdit_recovers_after_invalid_text) {
+	TPostfix postfix("(a + b) * c");
+	postfix.GetPostfix();
+	EXPECT_FALSE(postfix.applyEdit(3, 1, "+ *"));
+	EXPECT_THROW(postfix.GetPostfix(), std::invalid_argument);
+	EXPECT_FALSE(postfix.applyEdit(3, 3, "-"));
+	expectSameParse(postfix, "(a - b) * c");
+	EXPECT_THROW(postfix.applyEdit(20, 0, "x"), std::invalid_argument);
+}
+TEST(TPostfix, test_applyEdit_matches_full_parse_for_random_edits) {
+	const char* pieces[] = { "x", "1", "2.5", " ", "+", "-", "*", "(", ")", "sin(", "max(", ",", "y", "-3", "<", "?", ":", "&&" };
+	const std::string initial = "min(x, y) * (x + 1) - sin(y ^ 2) / (3 - x)";
+	std::string expression = initial;
+	TPostfix postfix(expression);
+	postfix.GetPostfix();
+	unsigned seed = 12345;
+	for (int step = 0; step < 2000; step++) {
+		if (step % 50 == 0) {
+			expression = initial;
+			postfix.setInfix(expression);
+			postfix.GetPostfix();
+		}
+		seed = seed * 1103515245u + 12345u;
+		size_t offset = (seed >> 8) % (expression.size() + 1);
+		seed = seed * 1103515245u + 12345u;
+		size_t removed = std::min<size_t>((seed >> 8) % 4, expression.size() - offset);
+		seed = seed * 1103515245u + 12345u;
+		std::string inserted = (seed >> 8) % 3 == 0 ? "" : pieces[(seed >> 12) % (sizeof(pieces) / sizeof(pieces[0]))];
+		std::string next = expression.substr(0, offset) + inserted + expression.substr(offset + removed);
+		TPostfix full(next);
+		if (full.diagnose().empty()) {
+			postfix.applyEdit(offset, removed, inserted);
+			expression = next;
+			expectSameParse(postfix, expression);
+		}
+	}
+}
+static void expectSameTokens(const std::string& expression) {
+	TPostfix serial(expression);
+	TPostfix parallel(expression);
+	parallel.setThreads(4);
+	std::vector<Token> a = serial.tokenize();
+	std::vector<Token> b = parallel.tokenize();
+	ASSERT_EQ(a.size(), b.size());
+	for (size_t i = 0; i < a.size(); i++) {
+		ASSERT_EQ(a[i].value, b[i].value) << i;
+		ASSERT_EQ(a[i].type, b[i].type) << i;
+		ASSERT_EQ(a[i].offset, b[i].offset) << i;
+		ASSERT_EQ(a[i].number, b[i].number) << i;
+	}
+}
+TEST(TPostfix, test_parallel_tokenize_matches_serial) {
+	std::string expression = "1";
+	for (int i = 0; i < 40000; i++) {
+		expression += i % 3 == 0 ? " - " : i % 3 == 1 ? "*-4-" : " <= ";
+		expression += i % 7 == 0 ? "sin  (x)" : i % 5 == 0 ? "(a -2.5e-3)" : "max(x,-1)";
+	}
+	expectSameTokens(expression);
+	TPostfix postfix(expression);
+	postfix.setThreads(4);
+	EXPECT_EQ(postfix.GetPostfix(), TPostfix(expression).GetPostfix());
+}
+TEST(TPostfix, test_parallel_tokenize_handles_minus_at_every_seam) {
+	std::string expression = "x";
+	for (int i = 0; i < 60000; i++) {
+		expression += i % 2 == 0 ? " -3" : " - y";
+	}
+	expectSameTokens(expression);
+	std::string dense = "1";
+	for (int i = 0; i < 60000; i++) {
+		dense += "+(x-2)*y";
+	}
+	expectSameTokens(dense);
+}
+static void expectSameDiagnostics(const std::string& expression) {
+	TPostfix serial(expression);
+	TPostfix parallel(expression);
+	parallel.setThreads(4);
+	std::vector<ParseError> a = serial.diagnose();
+	std::vector<ParseError> b = parallel.diagnose();
+	ASSERT_EQ(a.size(), b.size());
+	for (size_t i = 0; i < a.size(); i++) {
+		EXPECT_EQ(a[i].kind, b[i].kind);
+		EXPECT_EQ(a[i].offset, b[i].offset);
+		EXPECT_EQ(a[i].message, b[i].message);
+	}
+	if (a.empty()) {
+		EXPECT_EQ(serial.GetPostfix(), parallel.GetPostfix());
+	}
+}
+TEST(TPostfix, test_parallel_validate_matches_serial) {
+	std::string flat = "x";
+	std::string nested = "1";
+	for (int i = 0; i < 30000; i++) {
+		flat += i % 4 == 0 ? " * (y - 2)" : " + x";
+		nested += i % 4 == 0 ? " - max(x, (y + 1) * 2)" : i % 4 == 1 ? " + (x > 1 ? y : 2)" : " * y";
+	}
+	expectSameDiagnostics(flat);
+	expectSameDiagnostics(nested);
+	std::string broken[] = {
+		flat.substr(0, flat.size() / 2) + "*" + flat.substr(flat.size() / 2),
+		"(" + flat,
+		flat + ")",
+		flat.substr(0, flat.size() / 3) + ") + (" + flat.substr(flat.size() / 3),
+		flat + " +",
+		"* " + flat,
+		flat.substr(0, flat.size() / 2) + " y " + flat.substr(flat.size() / 2),
+		nested.substr(0, nested.size() / 2) + " , " + nested.substr(nested.size() / 2),
+		nested + " ? 1",
+	};
+	for (const std::string& expression : broken) {
+		expectSameDiagnostics(expression);
+	}
+}
+static void expectSameValue(const std::string& expression) {
+	TPostfix serial(expression);
+	TPostfix parallel(expression);
+	parallel.setThreads(4);
+	serial.SetVariable("x", 1.25);
+	serial.SetVariable("y", -0.5);
+	parallel.SetVariable("x", 1.25);
+	parallel.SetVariable("y", -0.5);
+	EXPECT_EQ(serial.calculate(), parallel.calculate());
+}
+TEST(TPostfix, test_parallel_calculate_matches_serial) {
+	std::string sum = "x";
+	std::string mixed = "1";
+	std::string chain = "x";
+	for (int i = 0; i < 20000; i++) {
+		sum += i % 3 == 0 ? " + sin(x * y) * 2" : " - y / 3";
+		mixed += i % 4 == 0 ? " + (x > y ? x : y)" : i % 4 == 1 ? " - (x < 0 && y < 0)" : " + max(x, y) ^ 2";
+		chain = "(" + chain + (i % 2 == 0 ? " + y)" : " * 1.0001)");
+	}
+	expectSameValue(sum);
+	expectSameValue(mixed);
+	expectSameValue(chain);
+	expectSameValue("(" + sum + ") * (" + mixed + ") - (" + sum + ") / (" + mixed + ")");
+}
+TEST(TPostfix, test_parallel_calculate_rethrows_error_from_subtree) {
+	std::string expression = "1";
+	for (int i = 0; i < 20000; i++) {
+		expression += i == 15000 ? " + x / 0" : " + x * y";
+	}
+	TPostfix postfix(expression);
+	postfix.setThreads(4);
+	postfix.SetVariable("x", 1);
+	postfix.SetVariable("y", 2);
+	EXPECT_ANY_THROW(postfix.calculate());
+}
+TEST(TPostfix, test_strict_mode_keeps_binary_chain) {
+	TPostfix postfix("a + b + c + d");
+	EXPECT_EQ(postfix.GetReassociation(), Reassociation::Strict);
+	EXPECT_EQ(postfix.compile().code.size(), 7);
+}
+TEST(TPostfix, test_pairwise_mode_flattens_chains) {
+	TPostfix postfix("a + b + (c + d) + e * f * g - h");
+	postfix.setReassociation(Reassociation::Pairwise);
+	const CompiledExpression& program = postfix.compile();
+	ASSERT_EQ(program.code.size(), 11);
+	EXPECT_EQ(program.code[7].op, OpCode::Product);
+	EXPECT_EQ(program.code[7].arg, 3);
+	EXPECT_EQ(program.code[8].op, OpCode::Sum);
+	EXPECT_EQ(program.code[8].arg, 5);
+	EXPECT_EQ(program.code[10].op, OpCode::Sub);
+	postfix.SetVariable("a", 1);
+	postfix.SetVariable("b", 2);
+	postfix.SetVariable("c", 3);
+	postfix.SetVariable("d", 4);
+	postfix.SetVariable("e", 2);
+	postfix.SetVariable("f", 3);
+	postfix.SetVariable("g", 4);
+	postfix.SetVariable("h", 5);
+	EXPECT_EQ(postfix.calculate(), 29.0);
+}
+TEST(TPostfix, test_pairwise_mode_keeps_conditionals_working) {
+	TPostfix postfix("x + (x > 0 ? x + 1 + x : 0) + (x < 0 || x + x + x > 1) + 2");
+	postfix.setReassociation(Reassociation::Pairwise);
+	postfix.SetVariable("x", 2);
+	EXPECT_EQ(postfix.calculate(), 10.0);
+	postfix.SetVariable("x", -1);
+	EXPECT_EQ(postfix.calculate(), 2.0);
+}
+TEST(TPostfix, test_compensated_sum_is_exact_for_repeated_tenths) {
+	std::string expression = "0.1";
+	for (int i = 1; i < 1000; i++) {
+		expression += " + 0.1";
+	}
+	TPostfix postfix(expression);
+	EXPECT_NE(postfix.calculate(), 100.0);
+	postfix.setReassociation(Reassociation::Compensated);
+	EXPECT_EQ(postfix.calculate(), 100.0);
+	postfix.setReassociation(Reassociation::Pairwise);
+	EXPECT_NEAR(postfix.calculate(), 100.0, 1e-13);
+}
+TEST(TPostfix, test_compensated_sum_recovers_cancelled_terms) {
+	TPostfix postfix("1e16 + 1 + 1 - 1e16");
+	postfix.setReassociation(Reassociation::Compensated);
+	EXPECT_EQ(postfix.compile().code[3].op, OpCode::CompensatedSum);
+	EXPECT_EQ(postfix.calculate(), 2.0);
+	TPostfix strict("1e16 + 1 + 1 - 1e16");
+	EXPECT_EQ(strict.calculate(), 0.0);
+}
+TEST(TPostfix, test_reassociated_batch_matches_scalar) {
+	Reassociation modes[] = { Reassociation::Pairwise, Reassociation::Compensated };
+	for (Reassociation mode : modes) {
+		TPostfix postfix("x + 0.1 + x * x * 3 + (x > 1 ? x + 1 + x : 0.3) + 1e8 + x");
+		postfix.setReassociation(mode);
+		std::vector<double> x(600), result(600);
+		for (size_t i = 0; i < x.size(); i++) {
+			x[i] = 0.37 * i - 50;
+		}
+		std::map<std::string, const double*> columns = { { "x", x.data() } };
+		postfix.calculateBatch(columns, x.size(), result.data());
+		for (size_t i = 0; i < x.size(); i++) {
+			postfix.SetVariable("x", x[i]);
+			EXPECT_EQ(result[i], postfix.calculate()) << i;
+		}
+	}
+}
+TEST(TPostfix, test_static_compile_accepts_reassociation_mode) {
+	auto compiled = TPostfix::compile("a + b + c", TFunctionTable(), Reassociation::Pairwise);
+	ASSERT_TRUE(compiled.hasValue());
+	ASSERT_EQ(compiled->code.size(), 4);
+	EXPECT_EQ(compiled->code[3].op, OpCode::Sum);
+}
+TEST(TPostfix, test_stack_depth_is_exact) {
+	TPostfix postfix("a + b + c + d");
+	EXPECT_EQ(postfix.GetStackDepth(), 2);
+	postfix.setInfix("a + (b + (c + d))");
+	EXPECT_EQ(postfix.GetStackDepth(), 4);
+	postfix.setInfix("max(a, b, c) * 2");
+	EXPECT_EQ(postfix.GetStackDepth(), 3);
+	postfix.setInfix("x > 0 ? (a + (b + c)) : 1 && y");
+	EXPECT_EQ(postfix.GetStackDepth(), 3);
+	postfix.setInfix("a + b + c + d + e");
+	postfix.setReassociation(Reassociation::Pairwise);
+	EXPECT_EQ(postfix.GetStackDepth(), 5);
+}
+TEST(TPostfix, test_stack_depth_of_long_flat_expression_is_small) {
+	std::string expression = "x";
+	for (int i = 0; i < 10000; i++) {
+		expression += i % 2 == 0 ? " + x * 2" : " - x / 3";
+	}
+	TPostfix postfix(expression);
+	EXPECT_EQ(postfix.GetStackDepth(), 3);
+	postfix.SetVariable("x", 3);
+	EXPECT_NEAR(postfix.calculate(), 3 + 5000 * 6 - 5000 * 1, 1e-6);
+}
+TEST(TPostfix, test_deep_nested_conditions_batch_matches_scalar) {
+	std::string expression = "x";
+	for (int i = 0; i < 40; i++) {
+		expression = "(x > " + std::to_string(i) + " ? (x + " + std::to_string(i) + ") * 2 : x - (" + expression + "))";
+	}
+	TPostfix postfix(expression);
+	std::vector<double> x(512), result(512);
+	for (size_t i = 0; i < x.size(); i++) {
+		x[i] = static_cast<double>(i % 50) - 5;
+	}
+	std::map<std::string, const double*> columns = { { "x", x.data() } };
+	postfix.calculateBatch(columns, x.size(), result.data());
+	for (size_t i = 0; i < x.size(); i++) {
+		postfix.SetVariable("x", x[i]);
+		EXPECT_EQ(result[i], postfix.calculate()) << i;
+	}
+}
+TEST(TPostfix, test_stacks_draw_from_given_memory_resource) {
+	char buffer[1 << 16];
+	std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+	std::pmr::memory_resource* previous = std::pmr::set_default_resource(std::pmr::null_memory_resource());
+	TPostfix postfix("(x + 1) * (x > 2 ? x : 2) + max(x, 3, 4) + x + x + x");
+	postfix.setMemoryResource(&arena);
+	postfix.setReassociation(Reassociation::Pairwise);
+	postfix.SetVariable("x", 3);
+	double value = 0;
+	std::vector<double> x = { 1, 3 }, result(2);
+	std::map<std::string, const double*> columns = { { "x", x.data() } };
+	EXPECT_NO_THROW(value = postfix.calculate());
+	EXPECT_NO_THROW(postfix.calculateBatch(columns, x.size(), result.data()));
+	std::pmr::set_default_resource(previous);
+	EXPECT_EQ(postfix.GetMemoryResource(), &arena);
+	EXPECT_EQ(value, 4 * 3 + 4 + 9);
+	EXPECT_EQ(result[1], value);
+	EXPECT_EQ(result[0], 2 * 2 + 4 + 3);
+}
+TEST(TPostfix, test_null_memory_resource_means_default) {
+	TPostfix postfix("1 + 2");
+	postfix.setMemoryResource(nullptr);
+	EXPECT_EQ(postfix.GetMemoryResource(), std::pmr::get_default_resource());
+	EXPECT_EQ(postfix.calculate(), 3.0);
+}
@@ -0,0 +1,65 @@
+//     
+#include <gtest.h>
+#include <arithmetic.h>
+#include <columns.h>
+#include <cstdio>
+#include <fstream>
+TEST(TColumnFile, test_write_and_open_preserves_names_and_values) {
+	std::vector<double> x = { 1.0, 2.5, -3.0 };
+	std::vector<double> y = { 4.0, 5.0, 6.0 };
+	TColumnFile::write("test_columns_roundtrip.tpcol", { "x", "y" }, { x.data(), y.data() }, x.size());
+	TColumnFile file("test_columns_roundtrip.tpcol");
+	EXPECT_EQ(file.GetRowCount(), 3);
+	EXPECT_EQ(file.GetColumnCount(), 2);
+	EXPECT_EQ(file.GetName(1), "y");
+	EXPECT_DOUBLE_EQ(file.find("x")[1], 2.5);
+	EXPECT_DOUBLE_EQ(file.GetColumn(1)[2], 6.0);
+	EXPECT_EQ(file.find("z"), nullptr);
+	std::remove("test_columns_roundtrip.tpcol");
+}
+TEST(TColumnFile, test_open_throws_for_missing_file) {
+	TColumnFile file;
+	EXPECT_THROW(file.open("test_columns_missing.tpcol"), std::runtime_error);
+}
+TEST(TColumnFile, test_open_throws_for_invalid_header) {
+	{
+		std::ofstream out("test_columns_invalid.tpcol", std::ios::binary);
+		out << "not a column file at all";
+	}
+	TColumnFile file;
+	EXPECT_THROW(file.open("test_columns_invalid.tpcol"), std::runtime_error);
+	std::remove("test_columns_invalid.tpcol");
+}
+TEST(TColumnFile, test_calculateBatch_matches_calculate_for_every_row) {
+	std::vector<double> a(1000), b(1000);
+	for (size_t i = 0; i < a.size(); i++) {
+		a[i] = 0.5 * i;
+		b[i] = 1000.0 - i;
+	}
+	TColumnFile::write("test_columns_batch.tpcol", { "a", "b" }, { a.data(), b.data() }, a.size());
+	TColumnFile file("test_columns_batch.tpcol");
+	TPostfix postfix("(a + b) * c - a / b ^ 2");
+	postfix.SetVariable("c", 3.0);
+	std::vector<double> result = postfix.calculateBatch(file);
+	ASSERT_EQ(result.size(), a.size());
+	for (size_t i = 0; i < a.size(); i++) {
+		postfix.SetVariable("a", a[i]);
+		postfix.SetVariable("b", b[i]);
+		EXPECT_DOUBLE_EQ(result[i], postfix.calculate());
+	}
+	std::remove("test_columns_batch.tpcol");
+}
+TEST(TColumnFile, test_calculateBatch_throws_for_unbound_variable) {
+	std::vector<double> a = { 1.0 };
+	TPostfix postfix("a + z");
+	std::map<std::string, const double*> columns = { { "a", a.data() } };
+	double result;
+	EXPECT_THROW(postfix.calculateBatch(columns, 1, &result), std::invalid_argument);
+}
+TEST(TColumnFile, test_calculateBatch_throws_on_division_by_zero) {
+	std::vector<double> a = { 1.0, 0.0 };
+	TPostfix postfix("1 / a");
+	std::map<std::string, const double*> columns = { { "a", a.data() } };
+	double result[2];
+	EXPECT_THROW(postfix.calculateBatch(columns, 2, result), std::runtime_error);
+}
@@ -0,0 +1,309 @@
+//        
+#include <gtest.h>
+#include <evaluator.h>
+#include <limits>
+TEST(TPostfixT, test_float_backend_calculates_expression) {
+	TPostfixT<float> postfix("(x + 2) * 3 - 1 / 4");
+	postfix.SetVariable("x", 1.5f);
+	EXPECT_FLOAT_EQ(postfix.calculate(), 10.25f);
+}
+TEST(TPostfixT, test_long_double_backend_calculates_expression) {
+	TPostfixT<long double> postfix("2 ^ 10 + x");
+	postfix.SetVariable("x", 0.5L);
+	EXPECT_EQ(postfix.calculate(), 1024.5L);
+}
+TEST(TPostfixT, test_fixed_backend_adds_decimals_exactly) {
+	TPostfixT<TFixed64> postfix("0.1 + 0.2");
+	EXPECT_EQ(postfix.calculate(), TFixed64(0.3));
+}
+TEST(TPostfixT, test_fixed_backend_multiplies_and_divides) {
+	TPostfixT<TFixed64> postfix("price * qty / 4");
+	postfix.SetVariable("price", TFixed64(19.99));
+	postfix.SetVariable("qty", TFixed64(3));
+	EXPECT_EQ(postfix.calculate().GetRaw(), 1499250000);
+}
+TEST(TPostfixT, test_fixed_backend_throws_on_division_by_zero) {
+	TPostfixT<TFixed64> postfix("1 / (x - x)");
+	postfix.SetVariable("x", TFixed64(2.5));
+	EXPECT_THROW(postfix.calculate(), std::runtime_error);
+}
+TEST(TPostfixT, test_backends_share_one_compiled_program) {
+	TPostfix source("a * b + 1");
+	const CompiledExpression& program = source.compile();
+	TPostfixT<float> single(program);
+	TPostfixT<TFixed64> fixed(program);
+	single.SetVariable("a", 2.0f);
+	single.SetVariable("b", 4.0f);
+	fixed.SetVariable("a", TFixed64(2.0));
+	fixed.SetVariable("b", TFixed64(4.0));
+	EXPECT_FLOAT_EQ(single.calculate(), 9.0f);
+	EXPECT_EQ(fixed.calculate(), TFixed64(9.0));
+}
+TEST(TPostfixT, test_float_batch_matches_scalar_calculate) {
+	TPostfixT<float> postfix("x * x - 2 * x + c");
+	postfix.SetVariable("c", 1.0f);
+	std::vector<float> x(600), result(600);
+	for (size_t i = 0; i < x.size(); i++) {
+		x[i] = 0.01f * i;
+	}
+	std::map<std::string, const float*> columns = { { "x", x.data() } };
+	postfix.calculateBatch(columns, x.size(), result.data());
+	for (size_t i = 0; i < x.size(); i++) {
+		postfix.SetVariable("x", x[i]);
+		EXPECT_FLOAT_EQ(result[i], postfix.calculate());
+	}
+}
+TEST(TPostfixT, test_constant_integer_exponent_compiles_to_integer_power) {
+	TPostfix postfix("x ^ 3 + t ^ -1");
+	const CompiledExpression& program = postfix.compile();
+	size_t integerPowers = 0;
+	for (const Instruction& instruction : program.code) {
+		EXPECT_NE(instruction.op, OpCode::Pow);
+		if (instruction.op == OpCode::PowInt) {
+			integerPowers++;
+		}
+	}
+	EXPECT_EQ(integerPowers, 2);
+	postfix.SetVariable("x", 1.5);
+	postfix.SetVariable("t", 4);
+	EXPECT_DOUBLE_EQ(postfix.calculate(), 3.625);
+}
+TEST(TPostfixT, test_fractional_exponent_keeps_generic_power) {
+	TPostfix postfix("x ^ 0.5");
+	EXPECT_EQ(postfix.compile().code.back().op, OpCode::Pow);
+	postfix.SetVariable("x", 9);
+	EXPECT_DOUBLE_EQ(postfix.calculate(), 3.0);
+}
+TEST(TPostfixT, test_integer_power_stays_within_documented_ulp_bound) {
+	for (int n = -POW_INT_LIMIT; n <= POW_INT_LIMIT; n++) {
+		for (double x = 0.37; x < 5.0; x += 0.41) {
+			double expected = std::pow(x, n);
+			double bound = (2 * std::log2(std::abs(n) + 1.0) + 1) * std::numeric_limits<double>::epsilon();
+			EXPECT_NEAR(powInteger<double>(x, n), expected, std::fabs(expected) * bound);
+		}
+	}
+}
+TEST(TPostfixT, test_variable_integral_exponent_uses_runtime_fast_path) {
+	TPostfix postfix("x ^ n");
+	postfix.SetVariable("x", -2);
+	postfix.SetVariable("n", 3);
+	EXPECT_DOUBLE_EQ(postfix.calculate(), -8.0);
+}
+TEST(TPostfixT, test_fixed_backend_integer_power_is_exact) {
+	TPostfixT<TFixed64> postfix("x ^ 2 - x ^ -1");
+	postfix.SetVariable("x", TFixed64(1.5));
+	EXPECT_EQ(postfix.calculate().GetRaw(), 158333334);
+}
+TEST(TPostfixT, test_batch_integer_power_matches_scalar) {
+	TPostfix postfix("x ^ 2 + x ^ 3 - x ^ 5");
+	std::vector<double> x(300), result(300);
+	for (size_t i = 0; i < x.size(); i++) {
+		x[i] = 0.01 * i - 1.0;
+	}
+	std::map<std::string, const double*> columns = { { "x", x.data() } };
+	postfix.calculateBatch(columns, x.size(), result.data());
+	for (size_t i = 0; i < x.size(); i++) {
+		postfix.SetVariable("x", x[i]);
+		EXPECT_DOUBLE_EQ(result[i], postfix.calculate());
+	}
+}
+TEST(TPostfixT, test_batch_functions_match_scalar) {
+	TPostfix postfix("sin(x) * cos(x) + exp(x) - log(x + 2) + sqrt(abs(x)) + max(x, 0.5)");
+	std::vector<double> x(300), result(300);
+	for (size_t i = 0; i < x.size(); i++) {
+		x[i] = 0.01 * i - 1.0;
+	}
+	std::map<std::string, const double*> columns = { { "x", x.data() } };
+	postfix.calculateBatch(columns, x.size(), result.data());
+	for (size_t i = 0; i < x.size(); i++) {
+		postfix.SetVariable("x", x[i]);
+		EXPECT_DOUBLE_EQ(result[i], postfix.calculate());
+	}
+}
+TEST(TPostfixT, test_fixed_backend_calculates_functions) {
+	TPostfixT<TFixed64> postfix("abs(x) + min(x, 1) + sqrt(4)");
+	postfix.SetVariable("x", TFixed64(-1.5));
+	EXPECT_EQ(postfix.calculate().GetRaw(), 200000000);
+}
+TEST(TPostfixT, test_batch_conditions_match_scalar) {
+	TPostfix postfix("x > 0.5 ? x * 2 : (x <= -0.5 || x == 0 ? 0 - x : !x + (x != 1 && x >= 0))");
+	std::vector<double> x(300), result(300);
+	for (size_t i = 0; i < x.size(); i++) {
+		x[i] = 0.01 * i - 1.0;
+	}
+	x[100] = 0.0;
+	std::map<std::string, const double*> columns = { { "x", x.data() } };
+	postfix.calculateBatch(columns, x.size(), result.data());
+	for (size_t i = 0; i < x.size(); i++) {
+		postfix.SetVariable("x", x[i]);
+		EXPECT_DOUBLE_EQ(result[i], postfix.calculate());
+	}
+}
+TEST(TPostfixT, test_fixed_backend_calculates_conditions) {
+	TPostfixT<TFixed64> postfix("x >= 0.5 && x < 1 ? x : -1");
+	postfix.SetVariable("x", TFixed64(0.5));
+	EXPECT_EQ(postfix.calculate().GetRaw(), 50000000);
+	postfix.SetVariable("x", TFixed64(1.0));
+	EXPECT_EQ(postfix.calculate().GetRaw(), -100000000);
+}
+TEST(TPostfixT, test_batch_skips_branch_for_uniform_mask) {
+	int scalarCalls = 0;
+	int blockCalls = 0;
+	TPostfix postfix("x >= 0 ? x : heavy(x)");
+	postfix.registerFunction("heavy", 1, [&scalarCalls](const double* args) {
+		scalarCalls++;
+		return -args[0];
+	}, [&blockCalls](const double* const* args, size_t n, double* out) {
+		blockCalls++;
+		for (size_t i = 0; i < n; i++) out[i] = -args[0][i];
+	});
+	std::vector<double> x(512), result(512);
+	for (size_t i = 0; i < x.size(); i++) {
+		x[i] = i < 256 ? static_cast<double>(i) : -1.0;
+	}
+	std::map<std::string, const double*> columns = { { "x", x.data() } };
+	postfix.calculateBatch(columns, x.size(), result.data());
+	EXPECT_EQ(blockCalls, 1);
+	EXPECT_EQ(scalarCalls, 0);
+	EXPECT_DOUBLE_EQ(result[10], 10.0);
+	EXPECT_DOUBLE_EQ(result[300], 1.0);
+}
+TEST(TPostfixT, test_batch_evaluates_sparse_branch_per_row) {
+	int scalarCalls = 0;
+	int blockCalls = 0;
+	TPostfix postfix("x >= 0 ? x : heavy(x)");
+	postfix.registerFunction("heavy", 1, [&scalarCalls](const double* args) {
+		scalarCalls++;
+		return -args[0];
+	}, [&blockCalls](const double* const* args, size_t n, double* out) {
+		blockCalls++;
+		for (size_t i = 0; i < n; i++) out[i] = -args[0][i];
+	});
+	std::vector<double> x(256, 1.0), result(256);
+	x[7] = -3.0;
+	x[200] = -5.0;
+	std::map<std::string, const double*> columns = { { "x", x.data() } };
+	postfix.calculateBatch(columns, x.size(), result.data());
+	EXPECT_EQ(blockCalls, 0);
+	EXPECT_EQ(scalarCalls, 2);
+	EXPECT_DOUBLE_EQ(result[7], 3.0);
+	EXPECT_DOUBLE_EQ(result[200], 5.0);
+	EXPECT_DOUBLE_EQ(result[8], 1.0);
+}
+TEST(TPostfixT, test_batch_masks_division_in_untaken_lanes) {
+	TPostfix postfix("(x != 0 ? (y || 1 / x > 1) + 1 / x : y) + (x && 1 / x)");
+	std::vector<double> x(700), y(700), result(700);
+	for (size_t i = 0; i < x.size(); i++) {
+		x[i] = i % 3 == 0 ? 0.0 : 0.5 * i;
+		y[i] = i % 2 == 0 ? 1.0 : 0.0;
+	}
+	for (size_t i = 256; i < 512; i++) {
+		y[i] = 1.0;
+	}
+	std::map<std::string, const double*> columns = { { "x", x.data() }, { "y", y.data() } };
+	ASSERT_NO_THROW(postfix.calculateBatch(columns, x.size(), result.data()));
+	for (size_t i = 0; i < x.size(); i++) {
+		postfix.SetVariable("x", x[i]);
+		postfix.SetVariable("y", y[i]);
+		EXPECT_DOUBLE_EQ(result[i], postfix.calculate());
+	}
+}
+TEST(TPostfixT, test_batch_nested_conditions_match_scalar) {
+	TPostfix postfix("a > 0 ? (b > 0 ? a * b : a - b) : (b > 0 && a > -0.5 ? b : a || b)");
+	std::vector<double> a(1000), b(1000), result(1000);
+	unsigned state = 12345;
+	for (size_t i = 0; i < a.size(); i++) {
+		state = state * 1103515245u + 12345u;
+		a[i] = static_cast<double>(state >> 16 & 0xFF) / 128.0 - (i < 500 ? 1.0 : 0.05);
+		state = state * 1103515245u + 12345u;
+		b[i] = static_cast<double>(state >> 16 & 0xFF) / 128.0 - 1.0;
+	}
+	std::map<std::string, const double*> columns = { { "a", a.data() }, { "b", b.data() } };
+	postfix.calculateBatch(columns, a.size(), result.data());
+	for (size_t i = 0; i < a.size(); i++) {
+		postfix.SetVariable("a", a[i]);
+		postfix.SetVariable("b", b[i]);
+		EXPECT_DOUBLE_EQ(result[i], postfix.calculate());
+	}
+}
+TEST(TBatchReport, test_division_by_zero_is_flagged_per_row) {
+	TPostfix postfix("1 / x + y");
+	std::vector<double> x(600, 2.0), result(600);
+	x[3] = 0.0;
+	x[299] = 0.0;
+	postfix.SetVariable("y", 1);
+	std::map<std::string, const double*> columns = { { "x", x.data() } };
+	TBatchReport report = postfix.calculateBatch(columns, x.size(), result.data(), TBatchOptions());
+	EXPECT_EQ(report.status, BatchStatus::Ok);
+	EXPECT_EQ(report.divisionByZero, 2);
+	EXPECT_EQ(report.failedRows, 2);
+	EXPECT_EQ(report.rowErrors[3], BATCH_DIVISION_BY_ZERO);
+	EXPECT_EQ(report.rowErrors[4], 0);
+	EXPECT_TRUE(std::isnan(result[299]));
+	EXPECT_DOUBLE_EQ(result[300], 1.5);
+}
+TEST(TBatchReport, test_ieee_division_and_non_finite_reporting) {
+	TPostfix postfix("a / x");
+	std::vector<double> a = { 1.0, 0.0, -1.0, 1.0 }, x = { 0.0, 0.0, 0.0, 4.0 }, result(4);
+	std::map<std::string, const double*> columns = { { "a", a.data() }, { "x", x.data() } };
+	TBatchOptions options;
+	options.divisionByZeroIsError = false;
+	TBatchReport quiet = postfix.calculateBatch(columns, a.size(), result.data(), options);
+	EXPECT_EQ(quiet.failedRows, 0);
+	EXPECT_EQ(result[0], std::numeric_limits<double>::infinity());
+	EXPECT_TRUE(std::isnan(result[1]));
+	options.nanIsError = true;
+	options.infinityIsError = true;
+	TBatchReport loud = postfix.calculateBatch(columns, a.size(), result.data(), options);
+	EXPECT_EQ(loud.infinity, 2);
+	EXPECT_EQ(loud.notANumber, 1);
+	EXPECT_EQ(loud.divisionByZero, 0);
+	EXPECT_EQ(loud.rowErrors[3], 0);
+}
+TEST(TBatchReport, test_binding_errors_are_returned_as_status) {
+	std::vector<double> result(4);
+	std::map<std::string, const double*> columns;
+	TPostfix postfix("x + 1");
+	TBatchReport report = postfix.calculateBatch(columns, result.size(), result.data(), TBatchOptions());
+	EXPECT_EQ(report.status, BatchStatus::UndefinedVariable);
+	EXPECT_EQ(report.message, "x");
+	postfix.setInfix("(x + 1");
+	report = postfix.calculateBatch(columns, result.size(), result.data(), TBatchOptions());
+	EXPECT_EQ(report.status, BatchStatus::InvalidExpression);
+	TFunctionTable table;
+	table.add("f", 1, [](const double* args) { return args[0]; });
+	TPostfix source("f(2)");
+	source.setFunctions(table);
+	postfix.setProgram(source.compile());
+	report = postfix.calculateBatch(columns, result.size(), result.data(), TBatchOptions());
+	EXPECT_EQ(report.status, BatchStatus::UnknownFunction);
+}
+TEST(TBatchReport, test_only_taken_branch_reports_errors) {
+	TPostfix postfix("x > 0 ? 1 / (x - 1) : 1 / x");
+	std::vector<double> x(256), result(256);
+	for (size_t i = 0; i < x.size(); i++) {
+		x[i] = i % 2 == 0 ? 1.0 : -1.0;
+	}
+	x[5] = 0.0;
+	std::map<std::string, const double*> columns = { { "x", x.data() } };
+	TBatchReport report = postfix.calculateBatch(columns, x.size(), result.data(), TBatchOptions());
+	EXPECT_EQ(report.divisionByZero, 129);
+	EXPECT_EQ(report.rowErrors[1], 0);
+	EXPECT_EQ(report.rowErrors[5], BATCH_DIVISION_BY_ZERO);
+}
+TEST(TBatchReport, test_fixed_backend_reports_division_by_zero) {
+	TPostfixT<TFixed64> postfix("1 / x");
+	std::vector<TFixed64> x = { TFixed64(2.0), TFixed64(0.0) }, result(2);
+	std::map<std::string, const TFixed64*> columns = { { "x", x.data() } };
+	TBatchReport report = postfix.calculateBatch(columns, x.size(), result.data(), TBatchOptions());
+	EXPECT_EQ(report.divisionByZero, 1);
+	EXPECT_EQ(result[0].GetRaw(), 50000000);
+	EXPECT_EQ(result[1].GetRaw(), 0);
+}
+TEST(TPostfixT, test_fixed_backend_reassociated_sum_is_exact) {
+	auto compiled = TPostfix::compile("a + 0.1 + 0.2 + a * a * a", TFunctionTable(), Reassociation::Compensated);
+	ASSERT_TRUE(compiled.hasValue());
+	TPostfixT<TFixed64> fixed(*compiled);
+	fixed.SetVariable("a", TFixed64(0.5));
+	EXPECT_EQ(fixed.calculate(), TFixed64(0.925));
+}
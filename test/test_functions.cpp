@@ -0,0 +1,114 @@
+//      
+#include <gtest.h>
+#include <evaluator.h>
+#include <library.h>
+#include <algorithm>
+namespace {
+double clamp(const double* args) {
+	return std::min(std::max(args[0], args[1]), args[2]);
+}
+double lerp(const double* args) {
+	return args[0] + (args[1] - args[0]) * args[2];
+}
+void lerpBlock(const double* const* args, size_t n, double* out) {
+	for (size_t i = 0; i < n; i++) {
+		out[i] = args[0][i] + (args[1][i] - args[0][i]) * args[2][i];
+	}
+}
+}
+TEST(TFunctionTable, test_add_rejects_invalid_definitions) {
+	TFunctionTable table;
+	table.add("clamp", 3, clamp);
+	EXPECT_THROW(table.add("clamp", 3, clamp), std::invalid_argument);
+	EXPECT_THROW(table.add("sin", 1, clamp), std::invalid_argument);
+	EXPECT_THROW(table.add("1f", 1, clamp), std::invalid_argument);
+	EXPECT_THROW(table.add("f", -1, clamp), std::invalid_argument);
+	EXPECT_THROW(table.add("g", 1, clamp, FUNCTION_CONSTANT_FOLDABLE), std::invalid_argument);
+	EXPECT_EQ(table.GetCount(), 1);
+}
+TEST(TFunctionTable, test_vectorizable_flag_requires_block) {
+	TFunctionTable table;
+	table.add("clamp", 3, clamp, FUNCTION_PURE | FUNCTION_VECTORIZABLE);
+	table.add("lerp", 3, lerp, lerpBlock);
+	EXPECT_FALSE(table.find("clamp")->flags & FUNCTION_VECTORIZABLE);
+	EXPECT_TRUE(table.find("lerp")->flags & FUNCTION_VECTORIZABLE);
+	EXPECT_EQ(table.find("none"), nullptr);
+}
+TEST(TPostfix, test_calculate_registered_functions) {
+	TPostfix postfix("clamp(x * 2, 0, 1) + lerp(a, b, 0.25)");
+	postfix.registerFunction("clamp", 3, clamp);
+	postfix.registerFunction("lerp", 3, lerp, lerpBlock);
+	postfix.SetVariable("x", 0.75);
+	postfix.SetVariable("a", 2);
+	postfix.SetVariable("b", 6);
+	EXPECT_EQ(postfix.GetPostfix(), "x 2 * 0 1 clamp a b 0.25 lerp +");
+	EXPECT_DOUBLE_EQ(postfix.calculate(), 4.0);
+}
+TEST(TPostfix, test_validate_registered_function_arity) {
+	TPostfix postfix("clamp(x, 1)");
+	postfix.registerFunction("clamp", 3, clamp);
+	EXPECT_THROW(postfix.validate(), std::invalid_argument);
+}
+TEST(TPostfix, test_constant_foldable_call_is_folded) {
+	int calls = 0;
+	TPostfix postfix("x + scale(2, 3) + scale(x, 1)");
+	postfix.registerFunction("scale", 2, [&calls](const double* args) {
+		calls++;
+		return args[0] * args[1];
+	}, FUNCTION_PURE | FUNCTION_CONSTANT_FOLDABLE);
+	postfix.SetVariable("x", 1);
+	const CompiledExpression& program = postfix.compile();
+	EXPECT_EQ(calls, 1);
+	EXPECT_EQ(program.functions.size(), 1);
+	EXPECT_DOUBLE_EQ(postfix.calculate(), 8.0);
+	EXPECT_EQ(calls, 2);
+}
+TEST(TPostfix, test_impure_call_is_not_folded) {
+	int calls = 0;
+	TPostfix postfix("tick() + tick()");
+	postfix.registerFunction("tick", 0, [&calls](const double*) {
+		return static_cast<double>(++calls);
+	}, 0);
+	EXPECT_DOUBLE_EQ(postfix.calculate(), 3.0);
+}
+TEST(TPostfix, test_batch_calls_block_overload_once_per_block) {
+	int blocks = 0;
+	TPostfix postfix("lerp(x, 10, 0.5) + clamp(x, 0, 1)");
+	postfix.registerFunction("lerp", 3, lerp, [&blocks](const double* const* args, size_t n, double* out) {
+		blocks++;
+		lerpBlock(args, n, out);
+	});
+	postfix.registerFunction("clamp", 3, clamp);
+	std::vector<double> x(600), result(600);
+	for (size_t i = 0; i < x.size(); i++) {
+		x[i] = 0.01 * i - 1.0;
+	}
+	std::map<std::string, const double*> columns = { { "x", x.data() } };
+	postfix.calculateBatch(columns, x.size(), result.data());
+	EXPECT_EQ(blocks, 3);
+	for (size_t i = 0; i < x.size(); i++) {
+		postfix.SetVariable("x", x[i]);
+		EXPECT_DOUBLE_EQ(result[i], postfix.calculate());
+	}
+}
+TEST(TPostfixT, test_fixed_backend_calls_registered_function) {
+	TFunctionTable table;
+	table.add("clamp", 3, clamp);
+	TPostfixT<TFixed64> postfix("clamp(x, 0, 1) * 2", table);
+	postfix.SetVariable("x", TFixed64(0.25));
+	EXPECT_EQ(postfix.calculate().GetRaw(), 50000000);
+}
+TEST(TFormulaLibrary, test_program_with_calls_needs_registered_function) {
+	TPostfix source("clamp(x, 0, 1)");
+	source.registerFunction("clamp", 3, clamp);
+	std::vector<unsigned char> data = TFormulaLibrary::serialize({ source.compile() });
+	std::vector<CompiledExpression> loaded = TFormulaLibrary::deserialize(data.data(), data.size());
+	ASSERT_EQ(loaded[0].functions.size(), 1);
+	EXPECT_EQ(loaded[0].functions[0].arity, 3);
+	TPostfix postfix;
+	postfix.setProgram(loaded[0]);
+	postfix.SetVariable("x", 5);
+	EXPECT_THROW(postfix.calculate(), std::invalid_argument);
+	postfix.registerFunction("clamp", 3, clamp);
+	EXPECT_DOUBLE_EQ(postfix.calculate(), 1.0);
+}
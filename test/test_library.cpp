@@ -0,0 +1,57 @@
+//       
+#include <gtest.h>
+#include <library.h>
+#include <cstdio>
+TEST(TFormulaLibrary, test_serialize_and_deserialize_preserve_program) {
+	TPostfix postfix("(x + 2.5) * y - x ^ 2");
+	CompiledExpression program = postfix.compile();
+	std::vector<unsigned char> data = TFormulaLibrary::serialize({ program });
+	std::vector<CompiledExpression> loaded = TFormulaLibrary::deserialize(data.data(), data.size());
+	ASSERT_EQ(loaded.size(), 1);
+	EXPECT_EQ(loaded[0].code.size(), program.code.size());
+	EXPECT_EQ(loaded[0].constants, program.constants);
+	EXPECT_EQ(loaded[0].names, program.names);
+	EXPECT_EQ(loaded[0].stackDepth, program.stackDepth);
+}
+TEST(TFormulaLibrary, test_loaded_program_calculates_without_infix) {
+	TPostfix source("(x + 2.5) * y - x ^ 2");
+	TFormulaLibrary::save("test_library.tplb", { source.compile() });
+	std::vector<CompiledExpression> loaded = TFormulaLibrary::load("test_library.tplb");
+	std::remove("test_library.tplb");
+	TPostfix postfix;
+	postfix.setProgram(loaded[0]);
+	postfix.SetVariable("x", 3);
+	postfix.SetVariable("y", 2);
+	EXPECT_DOUBLE_EQ(postfix.calculate(), 2.0);
+}
+TEST(TFormulaLibrary, test_deserialize_throws_on_checksum_mismatch) {
+	TPostfix postfix("a + b");
+	std::vector<unsigned char> data = TFormulaLibrary::serialize({ postfix.compile() });
+	data.back() ^= 0xFF;
+	EXPECT_THROW(TFormulaLibrary::deserialize(data.data(), data.size()), std::runtime_error);
+}
+TEST(TFormulaLibrary, test_deserialize_throws_on_unsupported_version) {
+	TPostfix postfix("a + b");
+	std::vector<unsigned char> data = TFormulaLibrary::serialize({ postfix.compile() });
+	data[4] = 99;
+	EXPECT_THROW(TFormulaLibrary::deserialize(data.data(), data.size()), std::runtime_error);
+}
+TEST(TFormulaLibrary, test_conditional_program_survives_round_trip) {
+	TPostfix source("x > 0 && y > 0 ? x * y : x || y");
+	std::vector<unsigned char> data = TFormulaLibrary::serialize({ source.compile() });
+	std::vector<CompiledExpression> loaded = TFormulaLibrary::deserialize(data.data(), data.size());
+	TPostfix postfix;
+	postfix.setProgram(loaded[0]);
+	postfix.SetVariable("x", 2);
+	postfix.SetVariable("y", 3);
+	EXPECT_DOUBLE_EQ(postfix.calculate(), 6.0);
+	postfix.SetVariable("y", -3);
+	EXPECT_DOUBLE_EQ(postfix.calculate(), 1.0);
+}
+TEST(TFormulaLibrary, test_serialize_rejects_backward_jump) {
+	TPostfix source("c ? a : b");
+	CompiledExpression program = source.compile();
+	program.code[3].arg = 1;
+	std::vector<unsigned char> data = TFormulaLibrary::serialize({ program });
+	EXPECT_THROW(TFormulaLibrary::deserialize(data.data(), data.size()), std::runtime_error);
+}
@@ -0,0 +1,63 @@
+//       
+#include <gtest.h>
+#include <pool.h>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+TEST(TTaskPool, test_group_runs_all_tasks) {
+	TTaskPool pool(3);
+	std::atomic<int> sum(0);
+	TTaskGroup group(pool);
+	for (int i = 1; i <= 100; i++) {
+		group.spawn([&sum, i] {
+			sum += i;
+		});
+	}
+	group.wait();
+	EXPECT_EQ(5050, sum);
+}
+TEST(TTaskPool, test_nested_groups_do_not_deadlock) {
+	TTaskPool pool(1);
+	std::atomic<int> count(0);
+	TTaskGroup outer(pool);
+	for (int i = 0; i < 8; i++) {
+		outer.spawn([&pool, &count] {
+			TTaskGroup inner(pool);
+			for (int j = 0; j < 8; j++) {
+				inner.spawn([&count] {
+					count++;
+				});
+			}
+			inner.wait();
+		});
+	}
+	outer.wait();
+	EXPECT_EQ(64, count);
+}
+TEST(TTaskPool, test_wait_rethrows_task_exception) {
+	TTaskPool pool(2);
+	TTaskGroup group(pool);
+	group.spawn([] {
+		throw std::runtime_error("task failed");
+	});
+	group.spawn([] {});
+	EXPECT_THROW(group.wait(), std::runtime_error);
+}
+TEST(TTaskPool, test_parallelFor_visits_every_index) {
+	TTaskPool pool(2);
+	std::vector<int> visited(50, 0);
+	parallelFor(pool, visited.size(), [&visited](size_t k) {
+		visited[k]++;
+	});
+	for (int count : visited) {
+		EXPECT_EQ(1, count);
+	}
+}
+TEST(TTaskPool, test_pool_without_workers_runs_inline) {
+	TTaskPool pool(0);
+	int count = 0;
+	parallelFor(pool, 4, [&count](size_t) {
+		count++;
+	});
+	EXPECT_EQ(4, count);
+}
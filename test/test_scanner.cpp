@@ -0,0 +1,44 @@
+//     
+#include <gtest.h>
+#include <scanner.h>
+#include <string>
+TEST(Scanner, test_classifyChars_marks_every_class) {
+	std::string text = " a1+(_)\t-*/^Z9. ";
+	text.resize(SCANNER_BLOCK, ' ');
+	TCharClasses classes = classifyChars(text.data(), text.size());
+	EXPECT_TRUE(classes.space & (1u << 0));
+	EXPECT_TRUE(classes.identifier & (1u << 1));
+	EXPECT_TRUE(classes.digit & (1u << 2));
+	EXPECT_TRUE(classes.op & (1u << 3));
+	EXPECT_TRUE(classes.bracket & (1u << 4));
+	EXPECT_TRUE(classes.identifier & (1u << 5));
+	EXPECT_TRUE(classes.space & (1u << 7));
+	EXPECT_EQ(classes.op & 0x0F00u, 0x0F00u);
+	EXPECT_TRUE(classes.identifier & (1u << 12));
+	EXPECT_EQ(classes.delimiter() & (1u << 14), 0u);
+}
+TEST(Scanner, test_classifyChars_agrees_with_scalar_tail) {
+	std::string text = "x_1 + (y2 ^ 3)\n-z/4*,min(a,b)>=!c&&d||e?f:g";
+	text.resize(SCANNER_BLOCK, '#');
+	TCharClasses block = classifyChars(text.data(), text.size());
+	for (size_t i = 0; i < text.size(); i++) {
+		TCharClasses single = classifyChars(text.data() + i, 1);
+		EXPECT_EQ((block.space >> i) & 1u, single.space & 1u);
+		EXPECT_EQ((block.digit >> i) & 1u, single.digit & 1u);
+		EXPECT_EQ((block.identifier >> i) & 1u, single.identifier & 1u);
+		EXPECT_EQ((block.op >> i) & 1u, single.op & 1u);
+		EXPECT_EQ((block.bracket >> i) & 1u, single.bracket & 1u);
+		EXPECT_EQ((block.separator >> i) & 1u, single.separator & 1u);
+	}
+}
+TEST(Scanner, test_skipSpaces_crosses_block_boundaries) {
+	std::string text(100, ' ');
+	text += "x";
+	EXPECT_EQ(skipSpaces(text.data(), text.data() + text.size()), text.data() + 100);
+}
+TEST(Scanner, test_findDelimiter_returns_end_for_long_word) {
+	std::string text(70, 'a');
+	EXPECT_EQ(findDelimiter(text.data(), text.data() + text.size()), text.data() + text.size());
+	text += ")";
+	EXPECT_EQ(findDelimiter(text.data(), text.data() + text.size()), text.data() + 70);
+}
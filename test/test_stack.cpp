@@ -1,6 +1,9 @@
 //   
 #include "stack.h"
 #include <gtest.h>
+#include <memory>
+#include <memory_resource>
+#include <string>
 TEST(TStack, test_of_constructor_with_positive_capacity_creates_empty_stack) {
 	TStack<int> stack(5);
 	EXPECT_TRUE(stack.isEmpty());
@@ -202,3 +205,210 @@ TEST(TStack, test_assigned_stack_contains_correct_elements) {
 }
 
 
+TEST(TStack, test_push_unchecked_and_pop_unchecked_keep_order) {
+	TStack<int> stack(3);
+	stack.push_unchecked(1);
+	stack.push_unchecked(2);
+	stack.push_unchecked(3);
+	EXPECT_TRUE(stack.isFull());
+	EXPECT_EQ(stack.pop_unchecked(), 3);
+	EXPECT_EQ(stack.pop_unchecked(), 2);
+	EXPECT_EQ(stack.GetSize(), 1);
+}
+TEST(TStack, test_unchecked_operations_mix_with_checked_ones) {
+	TStack<int> stack(2);
+	stack.push(1);
+	stack.push_unchecked(2);
+	stack.push(3);
+	EXPECT_EQ(stack.GetCapacity(), 4);
+	EXPECT_EQ(stack.pop_unchecked(), 3);
+	EXPECT_EQ(stack.peek(), 2);
+}
+TEST(TStack, test_geometric_growth_uses_given_factor) {
+	TStack<int, TGeometricGrowth<3, 2>> stack(4);
+	for (int i = 0; i < 5; i++) {
+		stack.push(i);
+	}
+	EXPECT_EQ(stack.GetCapacity(), 6);
+}
+TEST(TStack, test_fixed_growth_adds_increment) {
+	TStack<int, TFixedGrowth<3>> stack(2);
+	for (int i = 0; i < 6; i++) {
+		stack.push(i);
+	}
+	EXPECT_EQ(stack.GetCapacity(), 8);
+	EXPECT_EQ(stack.pop(), 5);
+}
+struct TExactGrowth {
+	static int grow(int, int required) {
+		return required;
+	}
+};
+TEST(TStack, test_user_growth_policy_is_used) {
+	TStack<int, TExactGrowth> stack(1);
+	stack.push(1);
+	stack.push(2);
+	stack.push(3);
+	EXPECT_EQ(stack.GetCapacity(), 3);
+}
+TEST(TStack, test_reserve_only_grows_capacity) {
+	TStack<int> stack(4);
+	stack.push(7);
+	stack.reserve(100);
+	EXPECT_EQ(stack.GetCapacity(), 100);
+	stack.reserve(10);
+	EXPECT_EQ(stack.GetCapacity(), 100);
+	EXPECT_EQ(stack.peek(), 7);
+}
+TEST(TStack, test_shrink_to_fit_releases_unused_capacity) {
+	TStack<std::string> stack(2);
+	for (int i = 0; i < 1000; i++) {
+		stack.push(std::to_string(i));
+	}
+	while (stack.GetSize() > 3) {
+		stack.pop();
+	}
+	stack.shrink_to_fit();
+	EXPECT_EQ(stack.GetCapacity(), 3);
+	EXPECT_EQ(stack.pop(), "2");
+	stack.clear();
+	stack.shrink_to_fit();
+	EXPECT_EQ(stack.GetCapacity(), 1);
+}
+TEST(TStack, test_resize_below_size_throws) {
+	TStack<int> stack(4);
+	stack.push(1);
+	stack.push(2);
+	EXPECT_THROW(stack.resize(1), std::invalid_argument);
+	EXPECT_EQ(stack.GetSize(), 2);
+}
+template<typename T>
+struct TCountingAllocator {
+	typedef T value_type;
+	int* allocated;
+	explicit TCountingAllocator(int* counter) : allocated(counter) {}
+	template<typename U>
+	TCountingAllocator(const TCountingAllocator<U>& other) : allocated(other.allocated) {}
+	T* allocate(size_t n) {
+		*allocated += static_cast<int>(n);
+		return std::allocator<T>().allocate(n);
+	}
+	void deallocate(T* p, size_t n) {
+		*allocated -= static_cast<int>(n);
+		std::allocator<T>().deallocate(p, n);
+	}
+	bool operator==(const TCountingAllocator& other) const {
+		return allocated == other.allocated;
+	}
+	bool operator!=(const TCountingAllocator& other) const {
+		return allocated != other.allocated;
+	}
+};
+TEST(TStack, test_memory_comes_from_given_allocator) {
+	int allocated = 0;
+	{
+		TStack<int, TGeometricGrowth<>, TCountingAllocator<int>> stack(4, TCountingAllocator<int>(&allocated));
+		EXPECT_EQ(allocated, 4);
+		for (int i = 0; i < 5; i++) {
+			stack.push(i);
+		}
+		EXPECT_EQ(allocated, 8);
+		stack.shrink_to_fit();
+		EXPECT_EQ(allocated, 5);
+	}
+	EXPECT_EQ(allocated, 0);
+}
+TEST(TStack, test_popped_and_cleared_elements_are_destroyed) {
+	std::shared_ptr<int> value = std::make_shared<int>(1);
+	TStack<std::shared_ptr<int>> stack(2);
+	stack.push(value);
+	stack.push(value);
+	stack.push(value);
+	EXPECT_EQ(value.use_count(), 4);
+	stack.pop();
+	EXPECT_EQ(value.use_count(), 3);
+	stack.clear();
+	EXPECT_EQ(value.use_count(), 1);
+}
+class TCountingResource : public std::pmr::memory_resource {
+public:
+	size_t allocations = 0;
+	size_t used = 0;
+private:
+	void* do_allocate(size_t bytes, size_t alignment) override {
+		allocations++;
+		used += bytes;
+		return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+	}
+	void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+		used -= bytes;
+		std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+	}
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+		return this == &other;
+	}
+};
+TEST(TStack, test_pmr_stack_allocates_from_given_resource) {
+	TCountingResource resource;
+	{
+		TPmrStack<int> stack(4, &resource);
+		for (int i = 0; i < 10; i++) {
+			stack.push(i);
+		}
+		EXPECT_EQ(stack.get_allocator().resource(), &resource);
+		EXPECT_EQ(resource.allocations, 3);
+		EXPECT_EQ(resource.used, 16 * sizeof(int));
+	}
+	EXPECT_EQ(resource.used, 0);
+}
+TEST(TStack, test_pmr_copy_uses_default_resource_and_move_keeps_resource) {
+	TCountingResource resource;
+	TPmrStack<int> stack(4, &resource);
+	stack.push(1);
+	TPmrStack<int> copy(stack);
+	EXPECT_EQ(copy.get_allocator().resource(), std::pmr::get_default_resource());
+	TPmrStack<int> moved(std::move(stack));
+	EXPECT_EQ(moved.get_allocator().resource(), &resource);
+	EXPECT_EQ(resource.allocations, 1);
+	EXPECT_EQ(moved.pop(), 1);
+	EXPECT_TRUE(stack.isEmpty());
+	stack.push(2);
+	EXPECT_EQ(stack.pop(), 2);
+}
+TEST(TStack, test_pmr_assignment_keeps_own_resource) {
+	TCountingResource first, second;
+	TPmrStack<int> a(2, &first);
+	TPmrStack<int> b(2, &second);
+	b.push(5);
+	b.push(6);
+	a = b;
+	EXPECT_EQ(a.get_allocator().resource(), &first);
+	EXPECT_EQ(a.pop(), 6);
+	a = std::move(b);
+	EXPECT_EQ(a.get_allocator().resource(), &first);
+	EXPECT_EQ(a.GetSize(), 2);
+	EXPECT_EQ(a.pop(), 6);
+	EXPECT_TRUE(b.isEmpty());
+	EXPECT_EQ(second.used, 2 * sizeof(int));
+}
+TEST(TStack, test_pmr_allocator_extended_copy_uses_given_resource) {
+	TCountingResource resource;
+	TPmrStack<int> stack(3);
+	stack.push(1);
+	stack.push(2);
+	TPmrStack<int> copy(stack, &resource);
+	EXPECT_EQ(copy.get_allocator().resource(), &resource);
+	EXPECT_EQ(copy.pop(), 2);
+	EXPECT_EQ(resource.allocations, 1);
+}
+TEST(TStack, test_move_assignment_with_std_allocator_steals_storage) {
+	TStack<std::string> a(2);
+	TStack<std::string> b(7);
+	b.push("x");
+	a = std::move(b);
+	EXPECT_EQ(a.GetCapacity(), 7);
+	EXPECT_EQ(a.pop(), "x");
+	swap(a, b);
+	EXPECT_EQ(a.GetCapacity(), 0);
+	EXPECT_EQ(b.GetCapacity(), 7);
+}
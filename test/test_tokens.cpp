@@ -0,0 +1,48 @@
+//        
+#include <gtest.h>
+#include <tokens.h>
+TEST(TokenBuffer, test_pushNumber_stores_constant_index) {
+	TokenBuffer buffer;
+	buffer.pushNumber(1.5, 0, 3);
+	buffer.push(TOKEN_OPERATOR, 0, 6, 4, 1);
+	buffer.pushNumber(2.5, 6, 3);
+	ASSERT_EQ(buffer.size(), 3u);
+	EXPECT_EQ(buffer.constants.size(), 2u);
+	EXPECT_DOUBLE_EQ(buffer.constants[buffer.values[2]], 2.5);
+	buffer.pop();
+	EXPECT_EQ(buffer.size(), 2u);
+	EXPECT_EQ(buffer.constants.size(), 1u);
+}
+TEST(TokenBuffer, test_replace_renumbers_constants) {
+	TokenBuffer buffer;
+	buffer.pushNumber(1, 0, 1);
+	buffer.push(TOKEN_OPERATOR, 0, 6, 2, 1);
+	buffer.pushNumber(2, 4, 1);
+	buffer.push(TOKEN_OPERATOR, 0, 6, 6, 1);
+	buffer.pushNumber(3, 8, 1);
+	TokenBuffer window;
+	window.pushNumber(7, 4, 1);
+	window.push(TOKEN_OPERATOR, 2, 7, 6, 1);
+	window.pushNumber(8, 8, 1);
+	buffer.replace(2, 3, window);
+	ASSERT_EQ(buffer.size(), 7u);
+	ASSERT_EQ(buffer.constants.size(), 4u);
+	double expected[] = { 1, 7, 8, 3 };
+	size_t number = 0;
+	for (size_t i = 0; i < buffer.size(); i++) {
+		if (buffer.kinds[i] == TOKEN_NUMBER) {
+			EXPECT_DOUBLE_EQ(buffer.constants[buffer.values[i]], expected[number++]);
+		}
+	}
+	EXPECT_EQ(number, 4u);
+}
+TEST(TokenBuffer, test_shift_moves_offsets_from_index) {
+	TokenBuffer buffer;
+	buffer.push(TOKEN_VARIABLE, 0, 0, 0, 1);
+	buffer.push(TOKEN_OPERATOR, 0, 6, 2, 1);
+	buffer.push(TOKEN_VARIABLE, 0, 0, 4, 1);
+	buffer.shift(1, 3);
+	EXPECT_EQ(buffer.offsets[0], 0u);
+	EXPECT_EQ(buffer.offsets[1], 5u);
+	EXPECT_EQ(buffer.offsets[2], 7u);
+}
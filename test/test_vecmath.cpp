@@ -0,0 +1,67 @@
+//     
+#include <gtest.h>
+#include <vecmath.h>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+namespace {
+int64_t ulpDistance(double a, double b) {
+	int64_t x, y;
+	std::memcpy(&x, &a, sizeof(x));
+	std::memcpy(&y, &b, sizeof(y));
+	if (x < 0) x = INT64_MIN - x;
+	if (y < 0) y = INT64_MIN - y;
+	return x > y ? x - y : y - x;
+}
+std::vector<double> samples(double low, double high, size_t count) {
+	std::vector<double> x(count);
+	for (size_t i = 0; i < count; i++) {
+		x[i] = low + (high - low) * i / (count - 1);
+	}
+	return x;
+}
+}
+TEST(VecMath, test_expBlock_within_one_ulp) {
+	std::vector<double> x = samples(-700.0, 700.0, 10007), out(x.size());
+	expBlock(x.data(), x.size(), out.data());
+	for (size_t i = 0; i < x.size(); i++) {
+		EXPECT_LE(ulpDistance(out[i], std::exp(x[i])), 1) << x[i];
+	}
+}
+TEST(VecMath, test_logBlock_within_one_ulp) {
+	std::vector<double> x = samples(1e-300, 1e300, 10007), out(x.size());
+	for (size_t i = 0; i < 1000; i++) {
+		x[i] = 0.5 + i * 0.001;
+	}
+	logBlock(x.data(), x.size(), out.data());
+	for (size_t i = 0; i < x.size(); i++) {
+		EXPECT_LE(ulpDistance(out[i], std::log(x[i])), 1) << x[i];
+	}
+}
+TEST(VecMath, test_sinBlock_cosBlock_within_two_ulp) {
+	std::vector<double> x = samples(-100.0, 100.0, 10007), sine(x.size()), cosine(x.size());
+	sinBlock(x.data(), x.size(), sine.data());
+	cosBlock(x.data(), x.size(), cosine.data());
+	for (size_t i = 0; i < x.size(); i++) {
+		EXPECT_LE(ulpDistance(sine[i], std::sin(x[i])), 2) << x[i];
+		EXPECT_LE(ulpDistance(cosine[i], std::cos(x[i])), 2) << x[i];
+	}
+}
+TEST(VecMath, test_blocks_handle_special_values) {
+	const double inf = std::numeric_limits<double>::infinity();
+	std::vector<double> x = { 0.0, -0.0, inf, -inf, -1.0, 1e6, 5e-324 }, out(x.size());
+	expBlock(x.data(), x.size(), out.data());
+	EXPECT_EQ(out[0], 1.0);
+	EXPECT_EQ(out[2], inf);
+	EXPECT_EQ(out[3], 0.0);
+	logBlock(x.data(), x.size(), out.data());
+	EXPECT_EQ(out[0], -inf);
+	EXPECT_EQ(out[2], inf);
+	EXPECT_TRUE(std::isnan(out[4]));
+	EXPECT_LE(ulpDistance(out[6], std::log(5e-324)), 1);
+	sinBlock(x.data(), x.size(), out.data());
+	EXPECT_TRUE(std::isnan(out[2]));
+	EXPECT_DOUBLE_EQ(out[5], std::sin(1e6));
+}